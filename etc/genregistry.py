@@ -36,6 +36,7 @@ tmp_lz78u_string_coder = context_free_coder + [
 
 bit_interleaving_coder = [
     ("ArithmeticCoder", "coders/ArithmeticCoder.hpp", []),
+    ("ANSCoder",        "coders/ANSCoder.hpp",        []),
 ]
 
 coder = tmp_lz78u_string_coder + bit_interleaving_coder + [
@@ -51,6 +52,8 @@ lz78_trie = [
     ("lz78::MyHashTrie",       "compressors/lz78/MyHashTrie.hpp",       []),
     ("lz78::TernaryTrie",      "compressors/lz78/TernaryTrie.hpp",      []),
     ("lz78::CedarTrie",        "compressors/lz78/CedarTrie.hpp",        []),
+    ("lz78::CompactHashTrie",  "compressors/lz78/CompactHashTrie.hpp",  []),
+    ("lz78::IncrementalHashTrie", "compressors/lz78/IncrementalHashTrie.hpp", []),
 ]
 
 if config_match("^#define JUDY_H_AVAILABLE 1"): lz78_trie += [
@@ -75,6 +78,7 @@ lcpc_buffer = [
     ("lcpcomp::CompactDec",           "compressors/lcpcomp/decompress/CompactDec.hpp",     []),
     ("lcpcomp::MyMapBuffer",                  "compressors/lcpcomp/decompress/MyMapBuffer.hpp",            []),
     ("lcpcomp::MultimapBuffer",               "compressors/lcpcomp/decompress/MultiMapBuffer.hpp",         []),
+    ("lcpcomp::SemiExternalDec",              "compressors/lcpcomp/decompress/SemiExternalDec.hpp",        []),
 ]
 
 lcpc_coder = [
@@ -101,9 +105,11 @@ compressors = [
     ("RePairCompressor",            "compressors/RePairCompressor.hpp",            [non_bit_interleaving_coder]),
     ("LZSSLCPCompressor",           "compressors/LZSSLCPCompressor.hpp",           [non_bit_interleaving_coder, textds]),
     ("LZSSSlidingWindowCompressor", "compressors/LZSSSlidingWindowCompressor.hpp", [context_free_coder]),
+    ("LZSSBlockCompressor",         "compressors/LZSSBlockCompressor.hpp",         [context_free_coder]),
     ("MTFCompressor",               "compressors/MTFCompressor.hpp",               []),
     ("NoopCompressor",              "compressors/NoopCompressor.hpp",              []),
     ("BWTCompressor",               "compressors/BWTCompressor.hpp",               [textds]),
+    ("BWTPipelineCompressor",       "compressors/BWTPipelineCompressor.hpp",       [coder]),
     ("ChainCompressor",             "../tudocomp_driver/ChainCompressor.hpp",      []),
 ]
 
@@ -1,7 +1,9 @@
 #pragma once
 
+#include <algorithm>
 #include <functional>
 #include <memory>
+#include <vector>
 
 #include <tudocomp/pre_header/Registry.hpp>
 #include <tudocomp/pre_header/Env.hpp>
@@ -34,6 +36,30 @@ public:
     /// \param input The input.
     /// \param output The output.
     virtual void decompress(Input& input, Output& output) = 0;
+
+    /// \brief Decompress the part [from, to) of the original input to the
+    /// given output.
+    ///
+    /// The default implementation decompresses the whole input into memory.
+    /// Compressors that support random access override it.
+    ///
+    /// \param input The input.
+    /// \param output The output.
+    /// \param from The first position to extract.
+    /// \param to The position after the last one to extract.
+    virtual void extract(Input& input, Output& output, size_t from, size_t to) {
+        std::vector<uint8_t> buffer;
+        {
+            Output decoded = Output::from_memory(buffer);
+            decompress(input, decoded);
+        }
+
+        to = std::min(to, buffer.size());
+        if(from < to) {
+            auto ostream = output.as_stream();
+            ostream.write(reinterpret_cast<const char*>(buffer.data() + from), to - from);
+        }
+    }
 };
 
 }
@@ -0,0 +1,293 @@
+#pragma once
+
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+#include <tudocomp/util.hpp>
+#include <tudocomp/Coder.hpp>
+
+namespace tdc {
+
+namespace ans {
+
+/// The lower bound of the coder state, which is kept in [L, 2^32 L).
+constexpr uint64_t L = 1ULL << 31;
+
+/// Scales the literal counts to frequencies that sum up to 2^precision,
+/// such that every occurring literal keeps a frequency of at least one.
+inline std::vector<uint32_t> normalize(const std::vector<size_t>& counts, size_t precision) {
+    const size_t total_freq = size_t(1) << precision;
+    size_t total = 0;
+    for(size_t c : counts) total += c;
+
+    std::vector<uint32_t> freq(counts.size(), 0);
+    size_t sum = 0;
+    for(size_t i = 0; i < counts.size(); ++i) {
+        if(counts[i] == 0) continue;
+        freq[i] = std::max(uint32_t(double(counts[i]) * total_freq / total), uint32_t(1));
+        sum += freq[i];
+    }
+
+    // correct the sum at the most frequent literals, which changes their
+    // code lengths the least (there are at most 2^8 literals, so the
+    // frequencies cannot all be one if the sum is too large)
+    while(sum != total_freq) {
+        const size_t max = std::max_element(freq.begin(), freq.end()) - freq.begin();
+        if(sum < total_freq) {
+            freq[max] += total_freq - sum;
+            sum = total_freq;
+        } else {
+            DCHECK_GT(freq[max], 1U);
+            const size_t d = std::min(sum - total_freq, size_t(freq[max] - 1));
+            freq[max] -= d;
+            sum -= d;
+        }
+    }
+    return freq;
+}
+
+} //ns ans
+
+/// \brief Encodes literals with static range asymmetric numeral systems
+///        (rANS).
+///
+/// The literal frequencies are counted from the literal iterator and scaled
+/// to `2^precision`, and are stored in the header. The coder state is a
+/// 64-bit integer that is renormalized in 32-bit words.
+///
+/// ANS encodes in reverse order, so literals are collected in blocks. The
+/// values that are encoded after the first literal of a block are held back
+/// and written after the encoded literals of the block, such that the
+/// decoder decodes all literals of the block when the first one is read.
+/// The decoder finds the literal of a state in a table with `2^precision`
+/// entries. Other values are encoded like by the base \ref Encoder.
+class ANSCoder : public Algorithm {
+public:
+    /// \brief Yields the coder's meta information.
+    /// \sa Meta
+    inline static Meta meta() {
+        Meta m("coder", "ans", "Static range asymmetric numeral system coding");
+        m.option("precision").dynamic(14);
+        return m;
+    }
+
+    /// The maximum number of literals in a block.
+    static constexpr size_t block_literals = 1ULL << 16;
+
+    /// The maximum number of values held back in a block.
+    static constexpr size_t block_values = 1ULL << 18;
+
+    /// \cond DELETED
+    ANSCoder() = delete;
+    /// \endcond
+
+    class Encoder : public tdc::Encoder {
+        size_t m_precision;
+        std::vector<uint32_t> m_freq;
+        std::vector<uint32_t> m_start; //! the cumulative frequencies
+
+        std::vector<uliteral_t> m_literals;
+        struct Value {
+            uint64_t v;
+            size_t bits;
+        };
+        std::vector<Value> m_values; //! the values held back
+        std::vector<uint32_t> m_words;
+
+        inline void write(uint64_t v, size_t bits) {
+            if(m_literals.empty()) {
+                m_out->write_int(v, bits);
+            } else {
+                m_values.push_back(Value { v, bits });
+                if(m_values.size() == block_values) flush();
+            }
+        }
+
+        /// Encodes the literals of the block and writes them, followed by
+        /// the values held back.
+        inline void flush() {
+            if(m_literals.empty()) return;
+
+            // the literals are encoded alternately with two states, which
+            // the decoder can update independently
+            uint64_t x[2] = { ans::L, ans::L };
+            m_words.clear();
+            for(size_t i = m_literals.size(); i > 0; --i) {
+                const uliteral_t c = m_literals[i - 1];
+                const uint64_t f = m_freq[c];
+                uint64_t& xi = x[(i - 1) & 1];
+                if(xi >= ((ans::L >> m_precision) << 32) * f) {
+                    m_words.push_back(uint32_t(xi));
+                    xi >>= 32;
+                }
+                xi = ((xi / f) << m_precision) + (xi % f) + m_start[c];
+            }
+
+            m_out->write_compressed_int(m_literals.size() - 1);
+            m_out->write_int(x[0], 64);
+            m_out->write_int(x[1], 64);
+            for(size_t i = m_words.size(); i > 0; --i) {
+                m_out->write_int(m_words[i - 1], 32);
+            }
+            for(const Value& v : m_values) {
+                m_out->write_int(v.v, v.bits);
+            }
+
+            m_literals.clear();
+            m_values.clear();
+        }
+
+    public:
+        template<typename literals_t>
+        inline Encoder(Env&& env, std::shared_ptr<BitOStream> out, literals_t&& literals)
+            : tdc::Encoder(std::move(env), out, literals) {
+
+            m_precision = this->env().option("precision").as_integer();
+            CHECK(m_precision >= 8 && m_precision <= 16)
+                << "the precision must be between 8 and 16";
+
+            std::vector<size_t> counts(ULITERAL_MAX + 1, 0);
+            size_t sigma = 0;
+            while(literals.has_next()) {
+                const uliteral_t c = literals.next().c;
+                if(counts[c]++ == 0) ++sigma;
+            }
+
+            m_out->write_bit(sigma > 0);
+            if(sigma == 0) return;
+
+            m_freq = ans::normalize(counts, m_precision);
+            m_start.resize(m_freq.size());
+            uint32_t start = 0;
+            for(size_t c = 0; c < m_freq.size(); ++c) {
+                m_start[c] = start;
+                start += m_freq[c];
+            }
+
+            m_out->write_int(m_precision, 5);
+            m_out->write_int(sigma - 1, 8);
+            for(size_t c = 0; c < m_freq.size(); ++c) {
+                if(m_freq[c] == 0) continue;
+                m_out->write_int(c, 8);
+                m_out->write_int(m_freq[c] - 1, m_precision);
+            }
+
+            m_literals.reserve(block_literals);
+        }
+
+        template<typename literals_t>
+        inline Encoder(Env&& env, Output& out, literals_t&& literals)
+            : Encoder(std::move(env), std::make_shared<BitOStream>(out), literals) {
+        }
+
+        ~Encoder() {
+            flush();
+        }
+
+        template<typename value_t>
+        inline void encode(value_t v, const Range& r) {
+            write(uint64_t(v - r.min()), bits_for(r.max() - r.min()));
+        }
+
+        template<typename value_t>
+        inline void encode(value_t v, const BitRange&) {
+            write(v ? 1 : 0, 1);
+        }
+
+        template<typename value_t>
+        inline void encode(value_t v, const LiteralRange&) {
+            if(tdc_unlikely(m_freq.empty())) {
+                m_out->write_int(static_cast<uliteral_t>(v), 8 * sizeof(uliteral_t));
+                return;
+            }
+
+            DCHECK_NE(m_freq[static_cast<uliteral_t>(v)], 0U) << "literal not in the alphabet";
+            m_literals.push_back(static_cast<uliteral_t>(v));
+            if(m_literals.size() == block_literals) flush();
+        }
+    };
+
+    class Decoder : public tdc::Decoder {
+        size_t m_precision;
+
+        std::vector<uliteral_t> m_slots; //! the literal of each state modulo 2^precision
+        std::vector<uint64_t> m_freq;
+        std::vector<uint64_t> m_start; //! the cumulative frequencies
+
+        std::vector<uliteral_t> m_literals; //! the decoded literals of the block
+        size_t m_pos;
+
+        inline void read_block() {
+            const size_t n = m_in->read_compressed_int<size_t>() + 1;
+            if(n > block_literals) throw std::runtime_error("invalid ANS block");
+
+            const uint64_t mask = (uint64_t(1) << m_precision) - 1;
+            uint64_t x[2];
+            x[0] = m_in->read_int<uint64_t>(64);
+            x[1] = m_in->read_int<uint64_t>(64);
+
+            auto step = [&](uint64_t& xi) {
+                const uliteral_t c = m_slots[xi & mask];
+                xi = m_freq[c] * (xi >> m_precision) + (xi & mask) - m_start[c];
+                if(xi < ans::L) xi = (xi << 32) | m_in->read_int<uint64_t>(32);
+                return c;
+            };
+
+            m_literals.resize(n);
+            size_t i = 0;
+            for(; i + 1 < n; i += 2) {
+                m_literals[i] = step(x[0]);
+                m_literals[i + 1] = step(x[1]);
+            }
+            if(i < n) m_literals[i] = step(x[0]);
+            m_pos = 0;
+        }
+
+    public:
+        DECODER_CTOR(env, in), m_precision(0), m_pos(0) {
+            if(!m_in->read_bit()) return;
+
+            m_precision = m_in->read_int<size_t>(5);
+            if(m_precision < 8 || m_precision > 16) {
+                throw std::runtime_error("invalid ANS precision");
+            }
+
+            const size_t sigma = m_in->read_int<size_t>(8) + 1;
+            m_slots.resize(size_t(1) << m_precision);
+            m_freq.resize(ULITERAL_MAX + 1, 0);
+            m_start.resize(ULITERAL_MAX + 1, 0);
+            size_t start = 0;
+            for(size_t i = 0; i < sigma; ++i) {
+                const uliteral_t c = m_in->read_int<uliteral_t>(8);
+                const size_t f = m_in->read_int<size_t>(m_precision) + 1;
+                if(start + f > m_slots.size()) {
+                    throw std::runtime_error("invalid ANS frequencies");
+                }
+                std::fill(m_slots.begin() + start, m_slots.begin() + start + f, c);
+                m_freq[c] = f;
+                m_start[c] = start;
+                start += f;
+            }
+            if(start != m_slots.size()) throw std::runtime_error("invalid ANS frequencies");
+        }
+
+        /// \brief Tests whether all values have been decoded.
+        inline bool eof() const {
+            return m_pos == m_literals.size() && m_in->eof();
+        }
+
+        using tdc::Decoder::decode;
+
+        template<typename value_t>
+        inline value_t decode(const LiteralRange&) {
+            if(tdc_unlikely(m_slots.empty())) {
+                return value_t(m_in->read_int<uliteral_t>());
+            }
+
+            if(m_pos == m_literals.size()) read_block();
+            return value_t(m_literals[m_pos++]);
+        }
+    };
+};
+
+} //ns
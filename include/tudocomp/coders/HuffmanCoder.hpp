@@ -1,7 +1,9 @@
 #pragma once
 
+#include <algorithm>
 #include <bitset>
 #include <numeric>
+#include <stdexcept>
 
 #include <tudocomp/Env.hpp>
 #include <tudocomp/Coder.hpp>
@@ -369,6 +371,38 @@ namespace huff {
             DVLOG(2) << "prefix_sum_lengths : " << arr_to_debug_string(prefix_sum_lengths, longest);
             return prefix_sum_lengths;
     }
+    /**
+     * The number of bits looked up in the decoding table (@see gen_decoding_table).
+     */
+    inline uint8_t decoding_table_bits(const uint8_t longest) {
+        return std::min(longest, uint8_t(11));
+    }
+
+    /**
+     * Generates a table decoding the codewords of up to `bits` bits with a single lookup.
+     * The entry of each `bits` bits stores the length of the codeword they start with in its upper
+     * byte and the character in its lower byte, or is zero if the codeword is longer.
+     */
+    inline uint16_t* gen_decoding_table(
+            const uliteral_t*const ordered_map_from_effective,
+            const uliteral_t*const numl,
+            const size_t*const firstcodes,
+            const uint8_t bits) {
+        uint16_t*const table = new uint16_t[1ULL << bits];
+        std::fill(table, table + (1ULL << bits), 0);
+
+        size_t k = 0; // the rank of the codeword in the effective alphabet
+        for(size_t length = 1; length <= bits; ++length) {
+            for(size_t j = 0; j < numl[length-1]; ++j, ++k) {
+                const size_t code = firstcodes[length-1] + j;
+                if(code >> length) throw std::runtime_error("invalid Huffman table");
+                const uint16_t entry = (length << 8) | ordered_map_from_effective[k];
+                std::fill(table + (code << (bits - length)), table + ((code + 1) << (bits - length)), entry);
+            }
+        }
+        return table;
+    }
+
     inline literal_t huffman_decode(
             tdc::io::BitIStream& is,
             const uliteral_t*const ordered_map_from_effective,
@@ -391,6 +425,38 @@ namespace huff {
 
     }
 
+    /**
+     * Decodes a single literal with the decoding table (@see gen_decoding_table).
+     * Codewords longer than `bits` bits are decoded further bit by bit.
+     */
+    inline literal_t huffman_decode(
+            tdc::io::BitIStream& is,
+            const uint16_t*const decoding_table,
+            const uint8_t bits,
+            const uliteral_t*const ordered_map_from_effective,
+            const size_t*const prefix_sum_lengths,
+            const size_t*const firstcodes
+            ) {
+        DCHECK(!is.eof());
+        size_t value = is.peek(bits);
+        const uint16_t entry = decoding_table[value];
+        if(tdc_likely(entry != 0)) {
+            is.skip(entry >> 8);
+            return entry & 0xFF;
+        }
+
+        // no shorter codeword is a prefix of the peeked bits
+        is.skip(bits);
+        uint8_t length = bits;
+        do {
+            DCHECK(!is.eof());
+            value = (value<<1) + is.read_bit();
+            ++length;
+        } while(value < firstcodes[length-1]);
+        --length;
+        return ordered_map_from_effective[prefix_sum_lengths[length]+ (value - firstcodes[length]) ];
+    }
+
 
     inline void huffman_decode(
             tdc::io::BitIStream& is,
@@ -407,12 +473,16 @@ namespace huff {
             DCHECK_GT(text_length, 0);
             const size_t*const firstcodes = gen_first_codes(numl, longest);
             DVLOG(2) << "firstcodes : " << arr_to_debug_string(firstcodes, longest);
+            const uint8_t bits = decoding_table_bits(longest);
+            const uint16_t*const decoding_table = gen_decoding_table(ordered_map_from_effective, numl, firstcodes, bits);
             size_t num_chars_read = 0;
             while(true) {
-                output << huffman_decode(is, ordered_map_from_effective, prefix_sum_lengths, firstcodes);
+                output << huffman_decode(is, decoding_table, bits, ordered_map_from_effective, prefix_sum_lengths, firstcodes);
                 ++num_chars_read;
                 if(num_chars_read == text_length) break;
             }
+            delete [] decoding_table;
+            delete [] prefix_sum_lengths;
             delete [] firstcodes;
     }
 
@@ -568,12 +638,15 @@ public:
         const uliteral_t* ordered_map_from_effective;
         const size_t* prefix_sum_lengths;
         const size_t* firstcodes;
+        const uint16_t* decoding_table;
+        uint8_t decoding_bits;
     public:
         ~Decoder() {
             if(tdc_likely(ordered_map_from_effective != nullptr)) {
                 delete [] ordered_map_from_effective;
                 delete [] prefix_sum_lengths;
                 delete [] firstcodes;
+                delete [] decoding_table;
             }
         }
 
@@ -591,6 +664,8 @@ public:
             prefix_sum_lengths = huff::gen_prefix_sum_lengths(ordered_codelengths, table.alphabet_size, table.longest);
             delete [] ordered_codelengths;
             firstcodes = huff::gen_first_codes(table.numl, table.longest);
+            decoding_bits = huff::decoding_table_bits(table.longest);
+            decoding_table = huff::gen_decoding_table(ordered_map_from_effective, table.numl, firstcodes, decoding_bits);
         }
 
         inline Decoder(Env&& env, Input& in)
@@ -603,7 +678,7 @@ public:
         inline value_t decode(const LiteralRange&) {
             if(tdc_unlikely(ordered_map_from_effective == nullptr))
                 return m_in->read_int<uliteral_t>();
-            return huff::huffman_decode(*m_in, ordered_map_from_effective, prefix_sum_lengths, firstcodes);
+            return huff::huffman_decode(*m_in, decoding_table, decoding_bits, ordered_map_from_effective, prefix_sum_lengths, firstcodes);
         }
     };
 };
@@ -5,11 +5,16 @@
 #include <tudocomp/ds/bwt.hpp>
 #include <tudocomp/ds/TextDS.hpp>
 #include <tudocomp/util.hpp>
+#include <tudocomp/util/vbyte.hpp>
 
 #include <tudocomp_stat/StatPhase.hpp>
 
 namespace tdc {
 
+/// Outputs the BWT of the text.
+///
+/// The BWT is preceded by the sampled positions of the text data structure's
+/// BWT, such that `threads` threads can invert it.
 template<typename text_t = TextDS<>>
 class BWTCompressor : public Compressor {
 
@@ -20,7 +25,8 @@ public:
     inline static Meta meta() {
         Meta m("compressor", "bwt", "BWT Compressor");
         m.option("textds").templated<text_t, TextDS<>>("textds");
-        m.uses_textds<text_t>(ds::SA);
+        m.option("threads").dynamic(1);
+        m.uses_textds<text_t>(ds::BWT);
         return m;
     }
 
@@ -31,27 +37,47 @@ public:
         auto in = input.as_view();
         DCHECK(in.ends_with(uint8_t(0)));
 
-        text_t t(env().env_for_option("textds"), in, text_t::SA);
+        text_t t(env().env_for_option("textds"), in);
 		DVLOG(2) << vec_to_debug_string(t);
-		const len_t input_size = t.size();
 
-        StatPhase::wrap("Construct Text DS", [&]{
-            t.require(text_t::SA);
-            DVLOG(2) << vec_to_debug_string(t.require_sa());
+        const auto bwt = StatPhase::wrap("Construct Text DS", [&]{
+            t.require_bwt();
+            return t.release_bwt();
         });
 
-        const auto& sa = t.require_sa();
-        for(size_t i = 0; i < input_size; ++i) {
-            ostream << bwt::bwt(t,sa,i);
-        }
+        write_vbyte(ostream, bwt.sample_rate());
+        write_vbyte(ostream, bwt.samples().size());
+        for(len_t s : bwt.samples()) write_vbyte(ostream, s);
+        ostream.write(reinterpret_cast<const char*>(bwt.data()), bwt.size());
     }
 
     inline virtual void decompress(Input& input, Output& output) override {
         auto in = input.as_view();
         auto ostream = output.as_stream();
 
+        if(in.empty()) return;
+
+        const uint8_t* p = in.data();
+        const uint8_t* end = p + in.size();
+        const size_t rate = read_vbyte<size_t>(p, end);
+        const size_t num_samples = read_vbyte<size_t>(p, end);
+        if(num_samples > size_t(end - p)) throw std::runtime_error("invalid BWT header");
+
+        std::vector<len_t> samples(num_samples);
+        for(auto& s : samples) s = read_vbyte<len_t>(p, end);
+
+        const View bwt = in.substr(p - in.data());
+        if(!bwt.empty()) {
+            const size_t required = rate > 0 ? (bwt.size() - 1) / rate : 0;
+            if(num_samples < required) throw std::runtime_error("too few BWT samples");
+            for(len_t s : samples) {
+                if(s >= bwt.size()) throw std::runtime_error("invalid BWT sample");
+            }
+        }
+
+        const size_t threads = env().option("threads").as_integer();
 		uliteral_t* decoded_string = StatPhase::wrap("Decode BWT", [&]{
-            return bwt::decode_bwt(in);
+            return bwt::decode_bwt(bwt, rate, samples.data(), threads);
         });
 
 		if(tdc_unlikely(decoded_string == nullptr)) {
@@ -0,0 +1,308 @@
+#pragma once
+
+#include <algorithm>
+#include <cstring>
+#include <future>
+#include <stdexcept>
+#include <vector>
+
+#include <tudocomp/Compressor.hpp>
+#include <tudocomp/io/BlockReader.hpp>
+#include <tudocomp/Literal.hpp>
+#include <tudocomp/Range.hpp>
+#include <tudocomp/util.hpp>
+#include <tudocomp/util/divsufsort.hpp>
+#include <tudocomp/util/vbyte.hpp>
+#include <tudocomp/ds/bwt.hpp>
+#include <tudocomp/compressors/MTFCompressor.hpp>
+#include <tudocomp/compressors/RunLengthEncoder.hpp>
+
+#include <tudocomp_stat/StatPhase.hpp>
+
+namespace tdc {
+
+/// Compresses the input block by block with the Burrows-Wheeler transform,
+/// Move-To-Front coding, run length encoding and an entropy coder.
+///
+/// The first three stages of up to `threads` blocks run in worker threads
+/// while the main thread encodes the finished blocks. Each block is written
+/// as a frame that starts with its size and its encoded size, such that
+/// the blocks can be found without decoding them.
+///
+/// The BWT of a block is taken of the block followed by an implicit
+/// sentinel, so the input does not need to be terminated. The positions of
+/// `segments` evenly spaced characters in the BWT are stored as well, such
+/// that the segments between them are inverted at the same time.
+template<typename coder_t>
+class BWTPipelineCompressor : public Compressor {
+
+private:
+    /// The buffers of a block to be compressed.
+    ///
+    /// All buffers are allocated when the block is created: the worker thread
+    /// must not allocate memory, since the memory tracking of \ref StatPhase
+    /// is not thread-safe.
+    struct Block {
+        std::vector<uliteral_t> text;
+        size_t size;
+
+        std::vector<saidx_t> work; //! the working array of divbwt
+        std::vector<saidx_t> bucket_a, bucket_b;
+
+        std::vector<uliteral_t> bwt; //! first the BWT, then its MTF codes
+        size_t primary; //! the row of the sentinel
+
+        size_t rate; //! the distance between two sampled text positions
+        std::vector<saidx_t> samples; //! the BWT positions of the samples
+        size_t num_samples;
+
+        std::vector<uliteral_t> rle;
+        size_t rle_size;
+
+        inline Block(size_t block_size, size_t segments)
+            : text(block_size)
+            , size(0)
+            , work(block_size)
+            , bucket_a(BUCKET_A_SIZE)
+            , bucket_b(BUCKET_B_SIZE)
+            , bwt(block_size)
+            , primary(0)
+            , rate(0)
+            , samples(segments)
+            , num_samples(0)
+            , rle(block_size + block_size / 2 + 1)
+            , rle_size(0) {}
+
+        /// Computes the BWT, its MTF codes and their run length encoding.
+        inline void transform() {
+            const size_t n = size;
+            rate = (n + samples.size() - 1) / samples.size();
+            num_samples = (n - 1) / rate;
+            primary = libdivsufsort::divbwt_run(text.data(), bwt.data(), work,
+                bucket_a.data(), bucket_b.data(), saidx_t(n),
+                saidx_t(rate), samples.data());
+
+            // the suffix array position i is the row i + 1, and the row of
+            // the sentinel is left out
+            for(size_t k = 0; k < num_samples; ++k) {
+                const size_t row = samples[k] + 1;
+                samples[k] = saidx_t(row < primary ? row : row - 1);
+            }
+
+            mtf_encode(bwt.data(), n, bwt.data());
+            rle_size = rle_encode(bwt.data(), n, rle.data());
+        }
+    };
+
+    /// The buffers of a block to be decompressed.
+    struct InverseBlock {
+        std::vector<uliteral_t> bwt;
+        size_t size;
+        size_t primary;
+
+        std::vector<len_t> samples;
+        std::vector<bwt::Segment> segments;
+
+        bwt::Inverter inverter;
+        std::vector<uliteral_t> text;
+
+        inline InverseBlock(size_t block_size, size_t num_segments)
+            : bwt(block_size)
+            , size(0)
+            , primary(0)
+            , inverter(block_size)
+            , text(block_size) {
+            samples.reserve(num_segments);
+            segments.reserve(num_segments);
+        }
+
+        inline void invert() {
+            inverter.invert(bwt.data(), size, primary,
+                segments.data(), segments.size(), text.data());
+        }
+    };
+
+    size_t m_block;
+    size_t m_threads;
+    size_t m_segments;
+
+public:
+    inline static Meta meta() {
+        Meta m("compressor", "bwt_pipeline",
+            "Burrows-Wheeler Transform Pipeline\n\n"
+            "Applies the BWT, Move-To-Front coding, run length encoding\n"
+            "and the coder to each block of `block` characters.\n"
+            "Up to `threads` blocks are transformed at the same time.\n"
+            "Each block is inverted in up to `segments` interleaved segments.");
+        m.option("coder").templated<coder_t>("coder");
+        m.option("block").dynamic(900000);
+        m.option("threads").dynamic(1);
+        m.option("segments").dynamic(int(bwt::Inverter::chains));
+        return m;
+    }
+
+    /// Default constructor (not supported).
+    inline BWTPipelineCompressor() = delete;
+
+    /// Construct the class with an environment.
+    inline BWTPipelineCompressor(Env&& e) : Compressor(std::move(e))
+    {
+        m_block = this->env().option("block").as_integer();
+        CHECK_GT(m_block, 0U) << "the block size must be positive";
+        // divsufsort works with signed integers
+        CHECK_LT(m_block, size_t(1) << 31) << "the block size is too large";
+
+        m_threads = std::max(size_t(this->env().option("threads").as_integer()), size_t(1));
+        m_segments = std::max(size_t(this->env().option("segments").as_integer()), size_t(1));
+    }
+
+    /// \copydoc
+    inline virtual void compress(Input& input, Output& output) override {
+        io::BlockReader ins(input);
+        View pending;
+
+        auto read = [&](Block& b) {
+            b.size = 0;
+            while(b.size < m_block) {
+                if(pending.empty()) {
+                    pending = ins.next_block();
+                    if(pending.empty()) break;
+                }
+                const size_t num = std::min(m_block - b.size, pending.size());
+                std::memcpy(b.text.data() + b.size, pending.data(), num);
+                b.size += num;
+                pending = pending.substr(num);
+            }
+        };
+
+        StatPhase phase("Transform");
+        phase.log_stat("block", m_block);
+        phase.log_stat("threads", m_threads);
+
+        std::vector<Block> blocks;
+        for(size_t k = 0; k < m_threads; ++k) blocks.emplace_back(m_block, m_segments);
+        std::vector<std::future<void>> transformed(m_threads);
+
+        // reads and transforms the next block into blocks[k]
+        bool more = true;
+        auto launch = [&](size_t k) {
+            read(blocks[k]);
+            more = blocks[k].size > 0;
+            if(more) {
+                transformed[k] = std::async(std::launch::async, &Block::transform, &blocks[k]);
+            }
+        };
+
+        for(size_t k = 0; k < m_threads && more; ++k) launch(k);
+
+        auto ostream = output.as_stream();
+        std::vector<uint8_t> encoded;
+        size_t num_blocks = 0;
+
+        // the blocks are launched and encoded in turn
+        for(size_t k = 0; transformed[k].valid(); k = (k + 1) % m_threads) {
+            transformed[k].get();
+            Block& b = blocks[k];
+
+            encoded.clear();
+            {
+                Output out = Output::from_memory(encoded);
+                typename coder_t::Encoder coder(env().env_for_option("coder"), out,
+                    ViewLiterals(View(b.rle.data(), b.rle_size)));
+                for(size_t i = 0; i < b.rle_size; ++i) coder.encode(b.rle[i], literal_r);
+            }
+
+            write_vbyte(ostream, b.size);
+            write_vbyte(ostream, b.primary);
+            write_vbyte(ostream, b.rate);
+            for(size_t i = 0; i < b.num_samples; ++i) write_vbyte(ostream, b.samples[i]);
+            write_vbyte(ostream, encoded.size());
+            ostream.write(reinterpret_cast<const char*>(encoded.data()), encoded.size());
+            ++num_blocks;
+
+            if(more) launch(k);
+        }
+
+        phase.log_stat("blocks", num_blocks);
+    }
+
+    /// The maximum number of bytes the coder writes for a block of n
+    /// characters: codewords take at most 64 bits per byte of the run length
+    /// encoding, and the coder's header fits in the last term.
+    inline static size_t max_coded_size(const size_t n) {
+        return 8 * rle::max_encoded_size(n) + 4096;
+    }
+
+    inline virtual void decompress(Input& input, Output& output) override {
+        auto istream = input.as_stream();
+        auto ostream = output.as_stream();
+
+        std::vector<InverseBlock> blocks;
+        for(size_t k = 0; k < m_threads; ++k) blocks.emplace_back(m_block, m_segments);
+        std::vector<std::future<void>> inverted(m_threads);
+
+        std::vector<uint8_t> encoded;
+        std::vector<uliteral_t> rle;
+
+        // reads, decodes and inverts the next block into blocks[k]
+        bool more = true;
+        auto launch = [&](size_t k) {
+            more = istream.peek() != std::char_traits<char>::eof();
+            if(!more) return;
+
+            InverseBlock& b = blocks[k];
+            b.size = read_vbyte<size_t>(istream);
+            b.primary = read_vbyte<size_t>(istream);
+            const size_t rate = read_vbyte<size_t>(istream);
+            if(b.size == 0 || b.size > m_block || b.primary == 0 || b.primary > b.size ||
+               rate == 0 || (b.size - 1) / rate >= m_segments) {
+                throw std::runtime_error("invalid block header");
+            }
+
+            b.samples.clear();
+            for(size_t i = 0; i < (b.size - 1) / rate; ++i) {
+                b.samples.push_back(read_vbyte<len_t>(istream));
+                if(b.samples.back() >= b.size) throw std::runtime_error("invalid block header");
+            }
+            bwt::segments(b.size, 0, rate, b.samples.data(), b.segments);
+
+            const size_t encoded_size = read_vbyte<size_t>(istream);
+            if(encoded_size > max_coded_size(b.size)) {
+                throw std::runtime_error("invalid block header");
+            }
+
+            encoded.resize(encoded_size);
+            istream.read(reinterpret_cast<char*>(encoded.data()), encoded_size);
+            if(size_t(istream.gcount()) != encoded_size) {
+                throw std::runtime_error("truncated block");
+            }
+
+            rle.clear();
+            {
+                Input in = Input::from_memory(encoded);
+                typename coder_t::Decoder decoder(env().env_for_option("coder"), in);
+                while(!decoder.eof()) {
+                    rle.push_back(decoder.template decode<uliteral_t>(literal_r));
+                }
+            }
+
+            if(rle_decode(rle.data(), rle.size(), b.bwt.data(), b.size) != b.size) {
+                throw std::runtime_error("run length encoded data too short");
+            }
+            mtf_decode(b.bwt.data(), b.size, b.bwt.data());
+
+            inverted[k] = std::async(std::launch::async, &InverseBlock::invert, &b);
+        };
+
+        for(size_t k = 0; k < m_threads && more; ++k) launch(k);
+
+        for(size_t k = 0; inverted[k].valid(); k = (k + 1) % m_threads) {
+            inverted[k].get();
+            ostream.write(reinterpret_cast<const char*>(blocks[k].text.data()), blocks[k].size);
+
+            if(more) launch(k);
+        }
+    }
+};
+
+} //ns
@@ -1,7 +1,10 @@
 #pragma once
 
 #include <tudocomp/Compressor.hpp>
+#include <tudocomp/io/BlockReader.hpp>
 #include <tudocomp/compressors/lz78/LZ78Trie.hpp>
+#include <tudocomp/compressors/lz78/Dictionary.hpp>
+#include <tudocomp/compressors/lz78/DecodeBuffer.hpp>
 #include <tudocomp/Range.hpp>
 
 #include <tudocomp_stat/StatPhase.hpp>
@@ -14,28 +17,53 @@ namespace tdc {
 	}
 
     namespace lz78 {
+        /// Restores the text from LZ78 factors with the same dictionary policy
+        /// as the compressor. A factor is copied from the decoded text.
         class Decompressor {
-            std::vector<lz78::factorid_t> indices;
-            std::vector<uliteral_t> literals;
+            Dictionary m_dict;
+            DecodeBuffer m_buffer;
+            uint64_t m_factor_count = 0;
 
             public:
-            inline void decompress(lz78::factorid_t index, uliteral_t literal, std::ostream& out) {
-                indices.push_back(index);
-                literals.push_back(literal);
-                std::vector<uliteral_t> buffer;
-
-                while(index != 0) {
-                    buffer.push_back(literal);
-                    literal = literals[index - 1];
-                    index = indices[index - 1];
-                }
+            inline Decompressor(DictPolicy policy, factorid_t max_size)
+                : m_dict(policy, max_size, 1, true), m_buffer(1) {}
+
+            /// The number of dictionary entries, including the root.
+            inline factorid_t size() const {
+                return m_dict.size();
+            }
 
-                out << literal;
-                for(size_t i = buffer.size(); i > 0; i--) {
-                    out << buffer[i - 1];
+            inline void decompress(lz78::factorid_t index, uliteral_t literal, std::ostream& out) {
+                DCHECK_LT(index, m_dict.size());
+                const size_t offset = m_buffer.size();
+                m_buffer.append(index);
+                m_buffer.append(literal);
+
+                const bool frozen = m_dict.frozen();
+                const factorid_t id = m_dict.size();
+                m_dict.touch(index, m_factor_count);
+                const Dictionary::Event event = m_dict.add(index, literal, m_factor_count++);
+                if(!frozen) m_buffer.set_entry(id, offset, m_buffer.length(index) + 1);
+
+                switch(event) {
+                    case Dictionary::Event::none:
+                        if(!frozen && m_dict.frozen()) {
+                            m_buffer.compact(out, id + 1, [](factorid_t i) { return i; }, true);
+                        }
+                        break;
+                    case Dictionary::Event::reset:
+                        m_buffer.reset(out);
+                        break;
+                    case Dictionary::Event::pruned:
+                        m_buffer.compact(out, id + 1, [&](factorid_t i) { return m_dict.renumbered(i); }, false);
+                        break;
                 }
+                m_buffer.flush_if_full(out);
             }
 
+            inline void flush(std::ostream& out) {
+                m_buffer.flush(out);
+            }
         };
     }//ns
 
@@ -45,45 +73,41 @@ class LZ78Compressor: public Compressor {
 private:
     using node_t = typename dict_t::node_t;
 
-    static inline lz78::factorid_t select_size(Env& env, string_ref name) {
-        auto& o = env.option(name);
-        if (o.as_string() == "inf") {
-            return 0;
-        } else {
-            return o.as_integer();
-        }
-    }
-
-    /// Max dictionary size before reset
-    const lz78::factorid_t m_dict_max_size {0};
+    /// Max dictionary size, 0 == unlimited
+    const lz78::factorid_t m_dict_max_size;
+    /// What to do if the dictionary is full
+    const lz78::DictPolicy m_dict_policy;
 
 public:
     inline LZ78Compressor(Env&& env):
         Compressor(std::move(env)),
-        m_dict_max_size(env.option("dict_size").as_integer())
+        m_dict_max_size(lz78::dict_size_option(this->env())),
+        m_dict_policy(lz78::dict_policy_option(this->env()))
     {}
 
     inline static Meta meta() {
-        Meta m("compressor", "lz78", "Lempel-Ziv 78\n\n" LZ78_DICT_SIZE_DESC);
+        Meta m("compressor", "lz78", "Lempel-Ziv 78\n\n" LZ78_DICT_SIZE_DESC "\n\n" LZ78_DICT_POLICY_DESC);
         m.option("coder").templated<coder_t, BitCoder>("coder");
         m.option("lz78trie").templated<dict_t, lz78::TernaryTrie>("lz78trie");
         m.option("dict_size").dynamic("inf");
+        m.option("dict_policy").dynamic("reset");
         return m;
     }
 
     virtual void compress(Input& input, Output& out) override {
         const size_t reserved_size = isqrt(input.size())*2;
-        auto is = input.as_stream();
+        io::BlockReader is(input);
 
         // Stats
         StatPhase phase1("Lz78 compression");
 
         len_t stat_dictionary_resets = 0;
+        len_t stat_dictionary_prunes = 0;
         len_t stat_dict_counter_at_last_reset = 0;
-        len_t stat_factor_count = 0;
-        len_t factor_count = 0;
+        uint64_t factor_count = 0;
 
         dict_t dict(env().env_for_option("lz78trie"), reserved_size);
+        lz78::Dictionary entries(m_dict_policy, m_dict_max_size, 1, false, reserved_size);
 
         auto reset_dict = [&dict] () {
             dict.clear();
@@ -101,26 +125,39 @@ public:
         DCHECK_EQ(node.id(), 0);
         DCHECK_EQ(parent.id(), 0);
 
-        char c;
+        uliteral_t c;
         while (is.get(c)) {
             node_t child = dict.find_or_insert(node, static_cast<uliteral_t>(c));
-            if(child.id() == lz78::undef_id) {
-                coder.encode(node.id(), Range(factor_count));
+            // a node beyond the size of a frozen dictionary is treated as not found
+            if(child.id() == lz78::undef_id || child.id() >= entries.size()) {
+                coder.encode(node.id(), Range(entries.size() - 1));
                 coder.encode(static_cast<uliteral_t>(c), literal_r);
+
+                entries.touch(node.id(), factor_count);
+                switch(entries.add(node.id(), static_cast<uliteral_t>(c), factor_count)) {
+                    case lz78::Dictionary::Event::reset: // dictionary's maximum size was reached
+                        reset_dict();
+                        stat_dictionary_resets++;
+                        stat_dict_counter_at_last_reset = m_dict_max_size;
+                        break;
+                    case lz78::Dictionary::Event::pruned:
+                        reset_dict();
+                        entries.rebuild(dict);
+                        stat_dictionary_prunes++;
+                        break;
+                    case lz78::Dictionary::Event::none:
+                        // a frozen dictionary still gets new leaves, which are removed from time to time
+                        if(entries.frozen() && dict.size() >= 2 * entries.size()) {
+                            reset_dict();
+                            entries.rebuild(dict);
+                        }
+                        break;
+                }
                 factor_count++;
-                stat_factor_count++;
                 parent = node = dict.get_rootnode(0); // return to the root
                 DCHECK_EQ(node.id(), 0);
                 DCHECK_EQ(parent.id(), 0);
-                DCHECK_EQ(factor_count+1, dict.size());
-                // dictionary's maximum size was reached
-                if(tdc_unlikely(dict.size() == m_dict_max_size)) { // if m_dict_max_size == 0 this will never happen
-                    DCHECK(false); // broken right now
-                    reset_dict();
-                    factor_count = 0; //coder.dictionary_reset();
-                    stat_dictionary_resets++;
-                    stat_dict_counter_at_last_reset = m_dict_max_size;
-                }
+                DCHECK(entries.frozen() || entries.size() == dict.size());
             } else { // traverse further
                 parent = node;
                 node = child;
@@ -129,16 +166,17 @@ public:
 
         // take care of left-overs. We do not assume that the stream has a sentinel
         if(node.id() != 0) {
-            coder.encode(parent.id(), Range(factor_count));
+            coder.encode(parent.id(), Range(entries.size() - 1));
             coder.encode(c, literal_r);
             DCHECK_EQ(dict.find_or_insert(parent, static_cast<uliteral_t>(c)).id(), node.id());
             factor_count++;
-            stat_factor_count++;
         }
 
-        phase1.log_stat("factor_count", stat_factor_count);
+        phase1.log_stat("factor_count", factor_count);
         phase1.log_stat("dictionary_reset_counter",
                        stat_dictionary_resets);
+        phase1.log_stat("dictionary_prune_counter",
+                       stat_dictionary_prunes);
         phase1.log_stat("max_factor_counter",
                        stat_dict_counter_at_last_reset);
     }
@@ -147,15 +185,14 @@ public:
         auto out = output.as_stream();
         typename coder_t::Decoder decoder(env().env_for_option("coder"), input);
 
-        lz78::Decompressor decomp;
-        uint64_t factor_count = 0;
+        lz78::Decompressor decomp(m_dict_policy, m_dict_max_size);
 
         while (!decoder.eof()) {
-            const lz78::factorid_t index = decoder.template decode<lz78::factorid_t>(Range(factor_count));
+            const lz78::factorid_t index = decoder.template decode<lz78::factorid_t>(Range(decomp.size() - 1));
             const uliteral_t chr = decoder.template decode<uliteral_t>(literal_r);
             decomp.decompress(index, chr, out);
-            factor_count++;
         }
+        decomp.flush(out);
 
         out.flush();
     }
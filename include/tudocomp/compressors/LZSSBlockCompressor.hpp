@@ -0,0 +1,250 @@
+#pragma once
+
+#include <algorithm>
+#include <cstring>
+#include <future>
+#include <vector>
+
+#include <tudocomp/Compressor.hpp>
+#include <tudocomp/io/BlockReader.hpp>
+#include <tudocomp/Literal.hpp>
+#include <tudocomp/Range.hpp>
+#include <tudocomp/util.hpp>
+#include <tudocomp/util/divsufsort.hpp>
+#include <tudocomp/compressors/lzss/LZSSDecodeWindowBuffer.hpp>
+#include <tudocomp/compressors/lzss/LZSSSmallerValues.hpp>
+
+#include <tudocomp_stat/StatPhase.hpp>
+
+namespace tdc {
+
+/// Computes an LZ77 factorization of the input block by block.
+///
+/// Each block is factorized greedily against itself and the previous block,
+/// using the suffix array and LCP array of both blocks. While a block is
+/// factorized, the arrays of the next block are constructed in a worker
+/// thread. Files and streams are read block by block by the \ref
+/// io::BlockReader, so the memory is bounded by the block size, while factors
+/// can still refer up to two blocks back. Only an input that is already in
+/// memory is viewed as a whole.
+template<typename coder_t>
+class LZSSBlockCompressor : public Compressor {
+
+private:
+    /// A block together with the previous block and the longest previous
+    /// factor of each of its positions.
+    ///
+    /// All buffers are allocated when the block is created: the worker thread
+    /// must not allocate memory, since the memory tracking of \ref StatPhase
+    /// is not thread-safe.
+    struct Block {
+        std::vector<uliteral_t> text; //! previous block followed by this block
+        size_t start; //! the position of this block in text
+        size_t end; //! the end of this block in text
+
+        std::vector<len_t> sa;
+        std::vector<len_t> plcp; //! first phi, then the permuted LCP array
+        lzss::SmallerValuesStack stack;
+        std::vector<saidx_t> bucket_a, bucket_b;
+
+        std::vector<len_t> src; //! source of the longest previous factor
+        std::vector<len_t> len; //! length of the longest previous factor
+
+        inline Block(size_t block_size)
+            : text(2 * block_size)
+            , start(0)
+            , end(0)
+            , sa(2 * block_size)
+            , plcp(2 * block_size)
+            , bucket_a(BUCKET_A_SIZE)
+            , bucket_b(BUCKET_B_SIZE)
+            , src(block_size)
+            , len(block_size)
+        {
+            stack.reserve(2 * block_size);
+        }
+
+        inline size_t size() const {
+            return end - start;
+        }
+
+        /// Constructs the suffix array and the permuted LCP array.
+        inline void construct() {
+            const size_t n = end;
+            const uliteral_t* t = text.data();
+
+            // suffix array
+            if(n > 2) {
+                libdivsufsort::divsufsort_run(t, sa, bucket_a.data(), bucket_b.data(), saidx_t(n));
+            } else if(n == 2) {
+                const bool m = t[0] < t[1];
+                sa[!m] = 0;
+                sa[m] = 1;
+            } else if(n == 1) {
+                sa[0] = 0;
+            }
+
+            // permuted LCP array with the phi algorithm
+            const len_t none = n;
+            if(n > 0) plcp[sa[0]] = none;
+            for(size_t j = 1; j < n; ++j) plcp[sa[j]] = sa[j - 1];
+
+            size_t l = 0;
+            for(size_t i = 0; i < n; ++i) {
+                const size_t p = plcp[i];
+                if(p == none) {
+                    l = 0;
+                } else {
+                    while(i + l < n && p + l < n && t[i + l] == t[p + l]) ++l;
+                }
+                plcp[i] = l;
+                if(l > 0) --l;
+            }
+        }
+
+        /// Computes the longest previous factor of each position of the block.
+        inline void analyze() {
+            const size_t n = end;
+
+            struct {
+                const Block* b;
+                inline len_t operator[](size_t j) const { return b->plcp[b->sa[j]]; }
+            } lcp { this };
+
+            // the longer of the previous and next smaller value,
+            // the closer one of equally long factors
+            std::fill(len.begin(), len.begin() + size(), 0);
+            for(size_t dir = 0; dir < 2; ++dir) {
+                lzss::smaller_values(sa, lcp, n, dir == 1, stack,
+                    [&](len_t i, len_t s, len_t l) {
+                        if(i < start) return;
+                        const size_t k = i - start;
+                        if(l > len[k] || (l == len[k] && l > 0 && s > src[k])) {
+                            src[k] = s;
+                            len[k] = l;
+                        }
+                    });
+            }
+        }
+    };
+
+    size_t m_block;
+
+public:
+    inline static Meta meta() {
+        Meta m("compressor", "lzss_block",
+            "Lempel-Ziv-Storer-Szymanski (Blockwise Suffix Array)\n\n"
+            "Factorizes each block of `block` characters against itself\n"
+            "and the previous block.");
+        m.option("coder").templated<coder_t>("coder");
+        m.option("block").dynamic(1 << 20);
+        m.option("threshold").dynamic(3);
+        return m;
+    }
+
+    /// Default constructor (not supported).
+    inline LZSSBlockCompressor() = delete;
+
+    /// Construct the class with an environment.
+    inline LZSSBlockCompressor(Env&& e) : Compressor(std::move(e))
+    {
+        m_block = this->env().option("block").as_integer();
+        CHECK_GT(m_block, 0U) << "the block size must be positive";
+        // divsufsort works with signed integers for two blocks
+        CHECK_LT(m_block, size_t(1) << 30) << "the block size is too large";
+    }
+
+    /// \copydoc
+    inline virtual void compress(Input& input, Output& output) override {
+        io::BlockReader ins(input, m_block);
+        View pending;
+
+        // reads the next block behind the current block b
+        auto read = [&](Block& b) {
+            while(b.end - b.start < m_block) {
+                if(pending.empty()) {
+                    pending = ins.next_block();
+                    if(pending.empty()) break;
+                }
+                const size_t num = std::min(m_block - (b.end - b.start), pending.size());
+                std::memcpy(b.text.data() + b.end, pending.data(), num);
+                b.end += num;
+                pending = pending.substr(num);
+            }
+        };
+
+        typename coder_t::Encoder coder(env().env_for_option("coder"), output, NoLiterals());
+
+        StatPhase phase("Factorize");
+
+        const len_t threshold = env().option("threshold").as_integer(); //factor threshold
+        phase.log_stat("threshold", threshold);
+        phase.log_stat("block", m_block);
+
+        Block blocks[2] = { Block(m_block), Block(m_block) };
+        read(blocks[0]);
+
+        auto construct = [](Block* b) { b->construct(); };
+        std::future<void> next = std::async(std::launch::async, construct, &blocks[0]);
+
+        size_t offset = 0; //text position of the current block
+        for(size_t k = 0; ; k ^= 1) {
+            next.get();
+            Block& cur = blocks[k];
+            if(cur.size() == 0) break;
+
+            // the current block is the previous block of the next block
+            Block& succ = blocks[k ^ 1];
+            std::memcpy(succ.text.data(), cur.text.data() + cur.start, cur.size());
+            succ.start = succ.end = cur.size();
+            read(succ);
+            if(succ.size() > 0) {
+                next = std::async(std::launch::async, construct, &succ);
+            }
+            cur.analyze();
+
+            for(size_t i = 0; i < cur.size();) {
+                const size_t fpos = offset + i;
+                const size_t flen = cur.len[i];
+                if(flen >= threshold && flen > 0) {
+                    // encode factor
+                    coder.encode(true, bit_r);
+                    coder.encode(cur.start + i - cur.src[i], Range(std::min(fpos, 2 * m_block))); //delta
+                    coder.encode(flen, Range(m_block));
+                    i += flen;
+                } else {
+                    // encode literal
+                    coder.encode(false, bit_r);
+                    coder.encode(cur.text[cur.start + i], literal_r);
+                    ++i;
+                }
+            }
+
+            offset += cur.size();
+            if(succ.size() == 0) break;
+        }
+    }
+
+    inline virtual void decompress(Input& input, Output& output) override {
+        typename coder_t::Decoder decoder(env().env_for_option("coder"), input);
+        auto outs = output.as_stream();
+
+        // factors refer at most two blocks back
+        const size_t window = 2 * m_block;
+        lzss::DecodeWindowBuffer text(window, outs);
+        while(!decoder.eof()) {
+            bool is_factor = decoder.template decode<bool>(bit_r);
+            if(is_factor) {
+                size_t fdist = decoder.template decode<size_t>(Range(std::min(text.size(), window)));
+                size_t fnum = decoder.template decode<size_t>(Range(m_block));
+                text.decode_factor(fdist, fnum);
+            } else {
+                auto c = decoder.template decode<uliteral_t>(literal_r);
+                text.decode_literal(c);
+            }
+        }
+        text.flush();
+    }
+};
+
+} //ns
@@ -11,6 +11,7 @@
 #include <tudocomp/compressors/lzss/LZSSFactors.hpp>
 #include <tudocomp/compressors/lzss/LZSSLiterals.hpp>
 #include <tudocomp/compressors/lzss/LZSSCoding.hpp>
+#include <tudocomp/compressors/lzss/LZSSOptimalParse.hpp>
 
 #include <tudocomp/ds/TextDS.hpp>
 
@@ -22,12 +23,40 @@ namespace tdc {
 /// LCP table.
 template<typename coder_t, typename text_t = TextDS<>>
 class LZSSLCPCompressor : public Compressor {
+private:
+    /// Computes the factorization of minimum estimated size. The second
+    /// pass refines the costs with the value ranges and literals of the
+    /// first one.
+    template<typename sa_t, typename lcp_t>
+    inline lzss::FactorBuffer optimal_parse(const text_t& text,
+        const sa_t& sa, const lcp_t& lcp, len_t threshold) {
+
+        const size_t n = text.size();
+        lzss::OptimalParser<text_t> parser(text, sa, lcp, threshold);
+
+        lzss::FactorBuffer factors;
+        factors = parser.parse(lzss::CostModel::measure<typename coder_t::Encoder>(
+            env().env_for_option("coder"), text, factors, threshold, n, n));
+
+        if(!factors.empty()) {
+            factors = parser.parse(lzss::CostModel::measure<typename coder_t::Encoder>(
+                env().env_for_option("coder"), text, factors,
+                factors.shortest_factor(), factors.longest_factor(),
+                lzss::longest_literal_run(n, factors)));
+        }
+        return factors;
+    }
+
 public:
     inline static Meta meta() {
-        Meta m("compressor", "lzss_lcp", "LZSS Factorization using LCP");
+        Meta m("compressor", "lzss_lcp", "LZSS Factorization using LCP\n\n"
+            "`parse` is either `greedy`, taking the longest previous factor\n"
+            "at each position, or `optimal`, minimizing the size estimated\n"
+            "for the coder.");
         m.option("coder").templated<coder_t>("coder");
         m.option("textds").templated<text_t, TextDS<>>("textds");
         m.option("threshold").dynamic(3);
+        m.option("parse").dynamic("greedy");
         m.uses_textds<text_t>(text_t::SA | text_t::ISA | text_t::LCP);
         return m;
     }
@@ -37,6 +66,8 @@ public:
 
     /// Construct the class with an environment.
     inline LZSSLCPCompressor(Env&& env) : Compressor(std::move(env)) {
+        const std::string parse = this->env().option("parse").as_string();
+        CHECK(parse == "greedy" || parse == "optimal") << "unknown parse \"" << parse << "\"";
     }
 
     inline virtual void compress(Input& input, Output& output) override {
@@ -60,53 +91,57 @@ public:
         StatPhase::wrap("Factorize", [&]{
             const len_t threshold = env().option("threshold").as_integer(); //factor threshold
 
-            for(len_t i = 0; i+1 < text_length;) { // we omit T[text_length-1] since we assume that it is the \0 byte!
-                //get SA position for suffix i
-                const size_t& cur_pos = isa[i];
-			    DCHECK_NE(cur_pos,0); // isa[i] == 0 <=> T[i] = 0
-
-			    //compute naively PSV
-                //search "upwards" in LCP array
-                //include current, exclude last
-                size_t psv_lcp = lcp[cur_pos];
-                ssize_t psv_pos = cur_pos - 1;
-                if (psv_lcp > 0) {
-                    while (psv_pos >= 0 && sa[psv_pos] > sa[cur_pos]) {
-                        psv_lcp = std::min<size_t>(psv_lcp, lcp[psv_pos--]);
+            if(env().option("parse").as_string() == "optimal") {
+                factors = optimal_parse(text, sa, lcp, threshold);
+            } else {
+                for(len_t i = 0; i+1 < text_length;) { // we omit T[text_length-1] since we assume that it is the \0 byte!
+                    //get SA position for suffix i
+                    const size_t& cur_pos = isa[i];
+    			    DCHECK_NE(cur_pos,0); // isa[i] == 0 <=> T[i] = 0
+
+    			    //compute naively PSV
+                    //search "upwards" in LCP array
+                    //include current, exclude last
+                    size_t psv_lcp = lcp[cur_pos];
+                    ssize_t psv_pos = cur_pos - 1;
+                    if (psv_lcp > 0) {
+                        while (psv_pos >= 0 && sa[psv_pos] > sa[cur_pos]) {
+                            psv_lcp = std::min<size_t>(psv_lcp, lcp[psv_pos--]);
+                        }
                     }
-                }
 
-			    //compute naively NSV, TODO: use NSV data structure
-                //search "downwards" in LCP array
-                //exclude current, include last
-                size_t nsv_lcp = 0;
-                size_t nsv_pos = cur_pos + 1;
-                if (nsv_pos < text_length) {
-                    nsv_lcp = SSIZE_MAX;
-                    do {
-                        nsv_lcp = std::min<size_t>(nsv_lcp, lcp[nsv_pos]);
-                        if (sa[nsv_pos] < sa[cur_pos]) {
-                            break;
+    			    //compute naively NSV, TODO: use NSV data structure
+                    //search "downwards" in LCP array
+                    //exclude current, include last
+                    size_t nsv_lcp = 0;
+                    size_t nsv_pos = cur_pos + 1;
+                    if (nsv_pos < text_length) {
+                        nsv_lcp = SSIZE_MAX;
+                        do {
+                            nsv_lcp = std::min<size_t>(nsv_lcp, lcp[nsv_pos]);
+                            if (sa[nsv_pos] < sa[cur_pos]) {
+                                break;
+                            }
+                        } while (++nsv_pos < text_length);
+
+                        if (nsv_pos >= text_length) {
+                            nsv_lcp = 0;
                         }
-                    } while (++nsv_pos < text_length);
-
-                    if (nsv_pos >= text_length) {
-                        nsv_lcp = 0;
                     }
-                }
 
-                //select maximum
-                const size_t& max_lcp = std::max(psv_lcp, nsv_lcp);
-                if(max_lcp >= threshold) {
-				    const ssize_t& max_pos = max_lcp == psv_lcp ? psv_pos : nsv_pos;
-				    DCHECK_LT(max_pos, text_length);
-				    DCHECK_GE(max_pos, 0);
-                    // new factor
-                    factors.emplace_back(i, sa[max_pos], max_lcp);
-
-                    i += max_lcp; //advance
-                } else {
-                    ++i; //advance
+                    //select maximum
+                    const size_t& max_lcp = std::max(psv_lcp, nsv_lcp);
+                    if(max_lcp >= threshold) {
+    				    const ssize_t& max_pos = max_lcp == psv_lcp ? psv_pos : nsv_pos;
+    				    DCHECK_LT(max_pos, text_length);
+    				    DCHECK_GE(max_pos, 0);
+                        // new factor
+                        factors.emplace_back(i, sa[max_pos], max_lcp);
+
+                        i += max_lcp; //advance
+                    } else {
+                        ++i; //advance
+                    }
                 }
             }
 
@@ -1,9 +1,14 @@
 #pragma once
 
+#include <cstring>
+
 #include <tudocomp/Compressor.hpp>
+#include <tudocomp/io/BlockReader.hpp>
 #include <tudocomp/Literal.hpp>
 #include <tudocomp/Range.hpp>
 #include <tudocomp/util.hpp>
+#include <tudocomp/compressors/lzss/LZSSDecodeWindowBuffer.hpp>
+#include <tudocomp/compressors/lzss/LZSSMatchFinder.hpp>
 
 #include <tudocomp_stat/StatPhase.hpp>
 
@@ -17,129 +22,131 @@ class LZSSSlidingWindowCompressor : public Compressor {
 private:
     size_t m_window;
 
-public:
-    inline static Meta meta() {
-        Meta m("compressor", "lzss", "Lempel-Ziv-Storer-Szymanski (Sliding Window)");
-        m.option("coder").templated<coder_t>("coder");
-        m.option("window").dynamic(16);
-        m.option("threshold").dynamic(3);
-        return m;
-    }
-
-    /// Default constructor (not supported).
-    inline LZSSSlidingWindowCompressor() = delete;
-
-    /// Construct the class with an environment.
-    inline LZSSSlidingWindowCompressor(Env&& e) : Compressor(std::move(e))
-    {
-        m_window = this->env().option("window").as_integer();
-    }
-
-    /// \copydoc
-    inline virtual void compress(Input& input, Output& output) override {
-        auto ins = input.as_stream();
+    /// Factorizes the input with the match finder `finder_t`.
+    template<class finder_t>
+    inline void factorize(Input& input, Output& output) {
+        io::BlockReader ins(input);
 
         typename coder_t::Encoder coder(env().env_for_option("coder"), output, NoLiterals());
 
-        std::vector<uint8_t> buf;
-
-        size_t ahead = 0; //marks the index in the buffer at which the back buffer ends and the ahead buffer begins
-        char c;
-
         StatPhase phase("Factorize");
 
-        //initially fill the buffer
-        size_t buf_off = 0;
-        while(buf.size() < 2 * m_window && ins.get(c)) {
-            buf.push_back(uint8_t(c));
-        }
-
-        //factorize
         const len_t threshold = env().option("threshold").as_integer(); //factor threshold
         phase.log_stat("threshold", threshold);
 
-        size_t pos = 0;
+        const size_t w = m_window;
+        finder_t finder(w, env().option("depth").as_integer(), threshold);
+
+        // the buffer holds the back window, the lookahead of up to w
+        // characters and room for at least w further characters
+        const size_t capacity = 2 * w + std::max(w, io::BlockReader::default_block_size);
+        std::vector<uliteral_t> buf(capacity);
+        size_t buf_off = 0; //text position of buf[0]
+        size_t end = 0; //number of characters in the buffer
+        size_t ahead = 0; //marks the index in the buffer at which the back buffer ends and the ahead buffer begins
         bool eof = false;
-        while(ahead < buf.size()) {
-            size_t fpos = 0, fsrc = 0, fnum = 0;
-
-            //walk back buffer
-            for(size_t k = (ahead > m_window ? ahead - m_window : 0); k < ahead; k++) {
-                //compare string
-                size_t j = 0;
-                while(ahead + j < buf.size() && buf[k + j] == buf[ahead + j]) {
-                    ++j;
-                }
 
-                //factorize if longer than one already found
-                if(j >= threshold && j > fnum) {
-                    fpos = buf_off + ahead;
-                    fsrc = buf_off + k;
-                    fnum = j;
-                }
+        // drops all but the last w characters before ahead and fills the buffer
+        auto refill = [&]() {
+            if(ahead > w) {
+                const size_t d = ahead - w;
+                std::memmove(buf.data(), buf.data() + d, end - d);
+                end -= d;
+                ahead -= d;
+                buf_off += d;
+                finder.slide(d);
             }
 
-            //output longest factor or symbol
-            size_t advance;
+            uliteral_t c;
+            while(end < capacity && ins.get(c)) buf[end++] = c;
+            eof = (end < capacity);
+        };
+
+        refill();
+        while(ahead < end) {
+            const lzss::Match m = finder.find(buf.data(), ahead, std::min(w, end - ahead));
 
-            if(fnum > 0) {
+            if(m.len >= threshold && m.len > 0) {
                 // encode factor
+                const size_t fpos = buf_off + ahead;
                 coder.encode(true, bit_r);
-                coder.encode(fpos - fsrc, Range(fpos)); //delta
-                coder.encode(fnum, Range(m_window));
+                coder.encode(m.dist, Range(fpos)); //delta
+                coder.encode(m.len, Range(w));
 
-                advance = fnum;
+                for(size_t k = 1; k < m.len; ++k) {
+                    ++ahead;
+                    if(!eof && end - ahead <= w) refill();
+                    finder.skip(buf.data(), ahead, std::min(w, end - ahead));
+                }
             } else {
                 // encode literal
                 coder.encode(false, bit_r);
-                coder.encode(uliteral_t(buf[ahead]), literal_r);
-
-                advance = 1;
+                coder.encode(buf[ahead], literal_r);
             }
 
-            //advance buffer
-            pos += advance;
-            while(advance--) {
-                if(ahead < m_window) {
-                    //case 1: still reading the first w symbols from the stream
-                    ++ahead;
-                } else if(!eof && ins.get(c)) {
-                    //case 2: read a new symbol
-                    buf.erase(buf.begin()); //TODO ouch
-                    buf.push_back(uint8_t(c));
-                    ++buf_off;
-                } else {
-                    //case 3: EOF, read rest of buffer
-                    eof = true;
-                    ++ahead;
-                }
-            }
+            ++ahead;
+            if(!eof && end - ahead <= w) refill();
+        }
+    }
+
+public:
+    inline static Meta meta() {
+        Meta m("compressor", "lzss", "Lempel-Ziv-Storer-Szymanski (Sliding Window)\n\n"
+            LZSS_FINDER_DESC);
+        m.option("coder").templated<coder_t>("coder");
+        m.option("window").dynamic(16);
+        m.option("threshold").dynamic(3);
+        m.option("finder").dynamic("hashchain");
+        m.option("depth").dynamic(32);
+        return m;
+    }
+
+    /// Default constructor (not supported).
+    inline LZSSSlidingWindowCompressor() = delete;
+
+    /// Construct the class with an environment.
+    inline LZSSSlidingWindowCompressor(Env&& e) : Compressor(std::move(e))
+    {
+        m_window = this->env().option("window").as_integer();
+        // the match finders store buffer positions in 32 bits
+        CHECK_LT(m_window, size_t(1) << 30) << "the window is too large";
+    }
+
+    /// \copydoc
+    inline virtual void compress(Input& input, Output& output) override {
+        const std::string finder = env().option("finder").as_string();
+        if(finder == "naive") {
+            factorize<lzss::NaiveFinder>(input, output);
+        } else if(finder == "hashchain") {
+            factorize<lzss::HashChainFinder>(input, output);
+        } else if(finder == "bt") {
+            factorize<lzss::BinaryTreeFinder>(input, output);
+        } else {
+            CHECK(false) << "unknown match finder \"" << finder << "\"";
         }
     }
 
     inline virtual void decompress(Input& input, Output& output) override {
         typename coder_t::Decoder decoder(env().env_for_option("coder"), input);
+        auto outs = output.as_stream();
 
-        std::vector<uliteral_t> text;
+        // factors refer at most m_window characters back
+        lzss::DecodeWindowBuffer text(m_window, outs);
         while(!decoder.eof()) {
             bool is_factor = decoder.template decode<bool>(bit_r);
             if(is_factor) {
-                size_t fsrc = text.size() - decoder.template decode<size_t>(Range(text.size()));
+                size_t fdist = decoder.template decode<size_t>(Range(text.size()));
 
                 //TODO are the compressor options saved into tudocomp's magic?
                 size_t fnum = decoder.template decode<size_t>(Range(m_window));
 
-                for(size_t i = 0; i < fnum; i++) {
-                    text.push_back(text[fsrc+i]);
-                }
+                text.decode_factor(fdist, fnum);
             } else {
                 auto c = decoder.template decode<uliteral_t>(literal_r);
-                text.push_back(c);
+                text.decode_literal(c);
             }
         }
-
-        auto outs = output.as_stream();
-        for(uint8_t c : text) outs << c;
+        text.flush();
     }
 };
 
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <tudocomp/Compressor.hpp>
+#include <tudocomp/io/BlockReader.hpp>
 
 #include <tudocomp/compressors/lzw/LZWDecoding.hpp>
 #include <tudocomp/compressors/lzw/LZWFactor.hpp>
@@ -22,48 +23,51 @@ class LZWCompressor: public Compressor {
 private:
     using node_t = typename dict_t::node_t;
 
-    const lz78::factorid_t m_dict_max_size {0}; //! Maximum dictionary size before reset, 0 == unlimited
+    const lz78::factorid_t m_dict_max_size; //! Maximum dictionary size, 0 == unlimited
+    const lz78::DictPolicy m_dict_policy; //! What to do if the dictionary is full
 public:
     inline LZWCompressor(Env&& env):
         Compressor(std::move(env)),
-        m_dict_max_size(env.option("dict_size").as_integer())
+        m_dict_max_size(lz78::dict_size_option(this->env())),
+        m_dict_policy(lz78::dict_policy_option(this->env()))
     {}
 
     inline static Meta meta() {
-        Meta m("compressor", "lzw", "Lempel-Ziv-Welch\n\n" LZ78_DICT_SIZE_DESC);
+        Meta m("compressor", "lzw", "Lempel-Ziv-Welch\n\n" LZ78_DICT_SIZE_DESC "\n\n" LZ78_DICT_POLICY_DESC);
         m.option("coder").templated<coder_t, BitCoder>("coder");
         m.option("lz78trie").templated<dict_t, lz78::TernaryTrie>("lz78trie");
         m.option("dict_size").dynamic(0);
+        m.option("dict_policy").dynamic("reset");
         return m;
     }
 
     virtual void compress(Input& input, Output& out) override {
 		const size_t reserved_size = isqrt(input.size())*2;
-        auto is = input.as_stream();
+        io::BlockReader is(input);
 
         // Stats
         StatPhase phase("LZW Compression");
         len_t stat_dictionary_resets = 0;
+        len_t stat_dictionary_prunes = 0;
         len_t stat_dict_counter_at_last_reset = 0;
-        len_t stat_factor_count = 0;
-        len_t factor_count = 0;
+        uint64_t factor_count = 0;
 
         dict_t dict(env().env_for_option("lz78trie"), reserved_size);
+        lz78::Dictionary entries(m_dict_policy, m_dict_max_size, ULITERAL_MAX + 1, false, reserved_size);
+
 		auto reset_dict = [&dict] () {
 			dict.clear();
-            std::stringstream ss;
 			for(size_t i = 0; i < ULITERAL_MAX+1; ++i) {
 				const node_t node = dict.add_rootnode(i);
 				DCHECK_EQ(node.id(), dict.size() - 1);
                 DCHECK_EQ(node.id(), i);
-                ss << node.id() << ", ";
 			}
 		};
 		reset_dict();
 
         typename coder_t::Encoder coder(env().env_for_option("coder"), out, NoLiterals());
 
-        char c;
+        uliteral_t c;
 		if(!is.get(c)) return;
 
 		node_t node = dict.get_rootnode(static_cast<uliteral_t>(c));
@@ -72,20 +76,33 @@ public:
 			node_t child = dict.find_or_insert(node, static_cast<uliteral_t>(c));
 			DVLOG(2) << " child " << child.id() << " #factor " << factor_count << " size " << dict.size() << " node " << node.id();
 
-			if(child.id() == lz78::undef_id) {
-                coder.encode(node.id(), Range(factor_count + ULITERAL_MAX + 1));
-                stat_factor_count++;
+			// a node beyond the size of a frozen dictionary is treated as not found
+			if(child.id() == lz78::undef_id || child.id() >= entries.size()) {
+                coder.encode(node.id(), Range(entries.size()));
+
+                entries.touch(node.id(), factor_count);
+                switch(entries.add(node.id(), static_cast<uliteral_t>(c), factor_count)) {
+                    case lz78::Dictionary::Event::reset: // dictionary's maximum size was reached
+                        reset_dict();
+                        stat_dictionary_resets++;
+                        stat_dict_counter_at_last_reset = m_dict_max_size;
+                        break;
+                    case lz78::Dictionary::Event::pruned:
+                        reset_dict();
+                        entries.rebuild(dict);
+                        stat_dictionary_prunes++;
+                        break;
+                    case lz78::Dictionary::Event::none:
+                        // a frozen dictionary still gets new leaves, which are removed from time to time
+                        if(entries.frozen() && dict.size() >= 2 * entries.size()) {
+                            reset_dict();
+                            entries.rebuild(dict);
+                        }
+                        break;
+                }
                 factor_count++;
-				DCHECK_EQ(factor_count+ULITERAL_MAX+1, dict.size());
+				DCHECK(entries.frozen() || entries.size() == dict.size());
                 node = dict.get_rootnode(static_cast<uliteral_t>(c));
-				// dictionary's maximum size was reached
-				if(dict.size() == m_dict_max_size) {
-					DCHECK_GT(dict.size(),0);
-					reset_dict();
-					factor_count = 0; //coder.dictionary_reset();
-					stat_dictionary_resets++;
-					stat_dict_counter_at_last_reset = m_dict_max_size;
-				}
 			} else { // traverse further
 				node = child;
 			}
@@ -94,41 +111,30 @@ public:
 		DLOG(INFO) << "End node id of LZW parsing " << node.id();
 		// take care of left-overs. We do not assume that the stream has a sentinel
 		DCHECK_NE(node.id(), lz78::undef_id);
-		coder.encode(node.id(), Range(factor_count + ULITERAL_MAX + 1)); //LZW
-		stat_factor_count++;
+		coder.encode(node.id(), Range(entries.size())); //LZW
 		factor_count++;
 
-        phase.log_stat("factor_count", stat_factor_count);
+        phase.log_stat("factor_count", factor_count);
         phase.log_stat("dictionary_reset_counter", stat_dictionary_resets);
+        phase.log_stat("dictionary_prune_counter", stat_dictionary_prunes);
         phase.log_stat("max_factor_counter", stat_dict_counter_at_last_reset);
     }
 
     virtual void decompress(Input& input, Output& output) override final {
-		const size_t reserved_size = input.size();
-        //TODO C::decode(in, out, dms, reserved_size);
         auto out = output.as_stream();
         typename coder_t::Decoder decoder(env().env_for_option("coder"), input);
 
-        len_t counter = 0;
-
-		//TODO file_corrupted not used!
-        lzw::decode_step([&](lz78::factorid_t& entry, bool reset, bool &file_corrupted) -> lzw::Factor {
-            if (reset) {
-                counter = 0;
-            }
+        lzw::Decompressor decomp(m_dict_policy, m_dict_max_size, isqrt(input.size())*2);
 
-            if(decoder.eof()) {
-                return false;
-            }
+        while(!decoder.eof()) {
+            const lzw::Factor factor(decoder.template decode<len_t>(Range(decomp.size())));
+            decomp.decompress(factor, out);
+        }
+        decomp.flush(out);
 
-            lzw::Factor factor(decoder.template decode<len_t>(Range(counter + ULITERAL_MAX + 1)));
-            counter++;
-            entry = factor;
-            return true;
-        }, out, m_dict_max_size == 0 ? lz78::DMS_MAX : m_dict_max_size, reserved_size);
+        out.flush();
     }
 
 };
 
 }
-
@@ -2,10 +2,16 @@
 
 #include <tudocomp/util.hpp>
 #include <tudocomp/Compressor.hpp>
+#include <tudocomp/io/BlockReader.hpp>
 #include <tudocomp/Env.hpp>
+#include <cstring>
 #include <numeric>
 #include <tudocomp/def.hpp>
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
 namespace tdc {
 
 
@@ -42,29 +48,158 @@ value_type mtf_decode_char(const value_type v, value_type*const table) {
 	return return_value;
 }
 
+/**
+ * The Move-To-Front table of all byte values.
+ *
+ * With SSE2, a character is searched by comparing 16 entries at once, and
+ * moving one of the first 16 entries to the front shifts them in a register.
+ * Later entries are moved with memmove. (Wider AVX2 loads are slower here:
+ * they cannot be forwarded from the preceding 16-byte store of the front.)
+ */
+class MTFTable {
+	static constexpr size_t table_size = ULITERAL_MAX+1;
+	alignas(16) uliteral_t m_table[table_size];
+
+	/// The position of the character c in the table.
+	inline size_t find(const uliteral_t c) const {
+		// the table contains every character, so the search stops
+#ifdef __SSE2__
+		const __m128i v = _mm_set1_epi8(c);
+		for(size_t b = 0;; b += 16) {
+			const __m128i x = _mm_load_si128(reinterpret_cast<const __m128i*>(m_table + b));
+			const uint32_t mask = _mm_movemask_epi8(_mm_cmpeq_epi8(x, v));
+			if(mask != 0) return b + __builtin_ctz(mask);
+		}
+#else
+		size_t i = 0;
+		while(m_table[i] != c) ++i;
+		return i;
+#endif
+	}
+
+	/// Moves the entry at position i to the front.
+	inline void move_to_front(const size_t i) {
+		const uliteral_t c = m_table[i];
+#ifdef __SSE2__
+		if(i < 16) {
+			const __m128i x = _mm_load_si128(reinterpret_cast<const __m128i*>(m_table));
+			const __m128i shifted = _mm_or_si128(_mm_slli_si128(x, 1), _mm_cvtsi32_si128(c));
+			// the entries behind position i stay
+			const __m128i keep = _mm_cmpgt_epi8(
+				_mm_setr_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15),
+				_mm_set1_epi8(char(i)));
+			_mm_store_si128(reinterpret_cast<__m128i*>(m_table),
+				_mm_or_si128(_mm_and_si128(keep, x), _mm_andnot_si128(keep, shifted)));
+			return;
+		}
+#endif
+		std::memmove(m_table + 1, m_table, i);
+		m_table[0] = c;
+	}
+
+public:
+	inline MTFTable() {
+		std::iota(m_table, m_table + table_size, 0);
+	}
+
+	/// Returns the Move-To-Front code of c.
+	inline uliteral_t encode(const uliteral_t c) {
+		if(m_table[0] == c) return 0;
+		const size_t i = find(c);
+		move_to_front(i);
+		return i;
+	}
+
+	/// Returns the character with the Move-To-Front code i.
+	inline uliteral_t decode(const uliteral_t i) {
+		const uliteral_t c = m_table[i];
+		move_to_front(i);
+		return c;
+	}
+};
+
+/**
+ * Encodes the n characters of `in` with Move-To-Front Coding into `out`.
+ * `in` and `out` may be the same buffer.
+ */
+inline void mtf_encode(MTFTable& table, const uliteral_t* in, size_t n, uliteral_t* out) {
+	for(size_t i = 0; i < n; ++i) {
+		out[i] = table.encode(in[i]);
+	}
+}
+
+/**
+ * Decodes the n Move-To-Front codes of `in` into `out`.
+ * `in` and `out` may be the same buffer.
+ */
+inline void mtf_decode(MTFTable& table, const uliteral_t* in, size_t n, uliteral_t* out) {
+	for(size_t i = 0; i < n; ++i) {
+		out[i] = table.decode(in[i]);
+	}
+}
+
+/// \copydoc mtf_encode(MTFTable&, const uliteral_t*, size_t, uliteral_t*)
+inline void mtf_encode(const uliteral_t* in, size_t n, uliteral_t* out) {
+	MTFTable table;
+	mtf_encode(table, in, n, out);
+}
+
+/// \copydoc mtf_decode(MTFTable&, const uliteral_t*, size_t, uliteral_t*)
+inline void mtf_decode(const uliteral_t* in, size_t n, uliteral_t* out) {
+	MTFTable table;
+	mtf_decode(table, in, n, out);
+}
+
+/**
+ * Applies the bulk coding function `f` of Move-To-Front Coding to the input
+ * read by `in`. The input is processed block by block, and each block is
+ * written at once.
+ */
+template<typename coding_t>
+inline void mtf_blockwise(io::BlockReader& in, std::ostream& os, coding_t f) {
+	MTFTable table;
+
+	static constexpr size_t chunk_size = io::BlockReader::default_block_size;
+	uliteral_t out[chunk_size];
+
+	for(View block = in.next_block(); !block.empty(); block = in.next_block()) {
+		for(size_t begin = 0; begin < block.size(); begin += chunk_size) {
+			const size_t num = std::min(block.size() - begin, chunk_size);
+			f(table, block.data() + begin, num, out);
+			os.write(reinterpret_cast<const char*>(out), num);
+		}
+	}
+}
+
+/// Encodes the input read by `in` with Move-To-Front Coding.
+inline void mtf_encode(io::BlockReader& in, std::ostream& os) {
+	mtf_blockwise(in, os, [](MTFTable& t, const uliteral_t* b, size_t n, uliteral_t* out) {
+		mtf_encode(t, b, n, out);
+	});
+}
+
+/// Decodes the Move-To-Front codes read by `in`.
+inline void mtf_decode(io::BlockReader& in, std::ostream& os) {
+	mtf_blockwise(in, os, [](MTFTable& t, const uliteral_t* b, size_t n, uliteral_t* out) {
+		mtf_decode(t, b, n, out);
+	});
+}
+
 template<class char_type = literal_t>
 void mtf_encode(std::basic_istream<char_type>& is, std::basic_ostream<char_type>& os) {
-	typedef typename std::make_unsigned<char_type>::type value_type; // -> default: uint8_t
-	static constexpr size_t table_size = std::numeric_limits<value_type>::max()+1;
-	value_type table[table_size];
-	std::iota(table, table+table_size, 0);
-
+	MTFTable table;
 	char_type c;
 	while(is.get(c)) {
-		os << mtf_encode_char(static_cast<value_type>(c), table, table_size);
+		os << char_type(table.encode(static_cast<uliteral_t>(c)));
 	}
 }
 
 template<class char_type = literal_t>
 void mtf_decode(std::basic_istream<char_type>& is, std::basic_ostream<char_type>& os) {
-	typedef typename std::make_unsigned<char_type>::type value_type; // -> default: uint8_t
-	static constexpr size_t table_size = std::numeric_limits<value_type>::max()+1;
-	value_type table[table_size];
-	std::iota(table, table+table_size, 0);
-
+	MTFTable table;
 	char_type c;
 	while(is.get(c)) {
-		os << mtf_decode_char(static_cast<value_type>(c), table);
+		os << char_type(table.decode(static_cast<uliteral_t>(c)));
 	}
 };
 
@@ -79,14 +214,14 @@ public:
     }
 
     inline virtual void compress(Input& input, Output& output) override {
-		auto is = input.as_stream();
+		io::BlockReader in(input);
 		auto os = output.as_stream();
-		mtf_encode(is,os);
+		mtf_encode(in,os);
 	}
     inline virtual void decompress(Input& input, Output& output) override {
-		auto is = input.as_stream();
+		io::BlockReader in(input);
 		auto os = output.as_stream();
-		mtf_decode(is,os);
+		mtf_decode(in,os);
 	}
 };
 
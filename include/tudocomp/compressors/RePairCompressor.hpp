@@ -1,11 +1,19 @@
 #pragma once
 
+#include <algorithm>
+#include <stdexcept>
+
 #include <tudocomp/Compressor.hpp>
 
 #include <tudocomp/Range.hpp>
+#include <tudocomp/util/vbyte.hpp>
 #include <tudocomp/coders/BitCoder.hpp> //default
 
-#include <tudocomp/util/Counter.hpp>
+#include <tudocomp/compressors/repair/Expander.hpp>
+#include <tudocomp/compressors/repair/LeanRePair.hpp>
+#include <tudocomp/compressors/repair/LinearRePair.hpp>
+#include <tudocomp/compressors/repair/NaiveRePair.hpp>
+#include <tudocomp/compressors/repair/ParallelRePair.hpp>
 
 #include <tudocomp_stat/StatPhase.hpp>
 
@@ -14,69 +22,57 @@ namespace tdc {
 template <typename coder_t>
 class RePairCompressor : public Compressor {
 private:
-    typedef uint32_t sym_t;
-    typedef uint64_t digram_t;
-    typedef std::vector<digram_t> grammar_t;
-    static const size_t digram_shift = 32UL;
-    static const sym_t sigma = 256; //TODO
-
-    inline static digram_t digram(sym_t l, sym_t r) {
-        return (digram_t(l) << digram_shift) | digram_t(r);
-    }
-
-    inline static sym_t left(digram_t di) {
-        return sym_t(di >> digram_shift);
-    }
-
-    inline static sym_t right(digram_t di) {
-        return sym_t(di);
-    }
+    typedef repair::sym_t sym_t;
+    typedef repair::digram_t digram_t;
+    typedef repair::grammar_t grammar_t;
+    static constexpr sym_t sigma = repair::sigma;
 
     template<typename text_t>
     class Literals : LiteralIterator {
     private:
-        const text_t* m_text;
-        len_t         m_text_size;
-        const len_t*  m_next;
-        len_t         m_pos;
+        const text_t*             m_text;
+        len_t                     m_pos;
 
         std::vector<uliteral_t> m_g_literals;
         len_t                   m_g_pos;
 
+        inline void skip_nonterminals() {
+            while(m_pos < m_text->size() && sym_t((*m_text)[m_pos]) >= sigma) ++m_pos;
+        }
+
     public:
-        inline Literals(const text_t& text,
-                        len_t text_size,
-                        const len_t* next,
-                        const grammar_t& grammar)
-            : m_text(&text), m_text_size(text_size), m_next(next),
-              m_pos(0), m_g_pos(0) {
+        inline Literals(const text_t& text, const grammar_t& grammar)
+            : m_text(&text), m_pos(0), m_g_pos(0) {
 
             // count literals from right side of grammar rules
             for(digram_t di : grammar) {
-                sym_t l = left(di);
+                sym_t l = repair::left(di);
                 if(l < sigma) m_g_literals.push_back(uliteral_t(l));
 
-                sym_t r = right(di);
+                sym_t r = repair::right(di);
                 if(r < sigma) m_g_literals.push_back(uliteral_t(r));
             }
+
+            skip_nonterminals();
         }
 
         inline bool has_next() const {
-            return m_pos < m_text_size || m_g_pos < m_g_literals.size();
+            return m_pos < m_text->size() || m_g_pos < m_g_literals.size();
         }
 
         inline Literal next() {
             assert(has_next());
 
-            if(m_pos < m_text_size) {
-                // from encoded text
-                auto l = Literal { uliteral_t((*m_text)[m_pos]), m_pos };
-                m_pos = m_next[m_pos];
+            if(m_pos < m_text->size()) {
+                // from the start rule
+                auto l = Literal { uliteral_t(sym_t((*m_text)[m_pos])), m_pos };
+                ++m_pos;
+                skip_nonterminals();
                 return l;
             } else {
                 // from grammar right sides
                 auto l = Literal { m_g_literals[m_g_pos],
-                                   m_text_size + 2 * m_g_pos };
+                                   len_t(m_text->size() + 2 * m_g_pos) };
                 ++m_g_pos;
                 return l;
             }
@@ -85,106 +81,86 @@ private:
 
 public:
     inline static Meta meta() {
-        Meta m("compressor", "repair", "Re-Pair compression");
+        Meta m("compressor", "repair", "Re-Pair compression\n\n"
+            "`mode` selects how the grammar is computed:\n"
+            "`linear` updates the digram frequencies incrementally\n"
+            "(Larsson and Moffat),\n"
+            "`naive` recounts all digrams for each rule, and\n"
+            "`lean` computes the same grammar as `naive`, but keeps the\n"
+            "text bit-packed and compacts it after each rule.\n\n"
+            "`threads` is the number of threads of the `naive` mode;\n"
+            "the other modes are sequential and reject other values than 1.\n\n"
+            "If `sample` is nonzero, the start rule is stored with a\n"
+            "fixed width behind the grammar, together with the text\n"
+            "position of every `sample`-th symbol, such that a part of\n"
+            "the text can be extracted without decoding the start rule\n"
+            "before it.");
         m.option("coder").templated<coder_t, BitCoder>("coder");
         m.option("max_rules").dynamic(0);
+        m.option("mode").dynamic("linear");
+        m.option("threads").dynamic(1);
+        m.option("sample").dynamic(0);
         return m;
     }
 
-    inline RePairCompressor(Env&& env) : Compressor(std::move(env)) {}
+    inline RePairCompressor(Env&& env) : Compressor(std::move(env)) {
+        const std::string mode = this->env().option("mode").as_string();
+        CHECK(mode == "linear" || mode == "naive" || mode == "lean") << "unknown mode \"" << mode << "\"";
+        const size_t threads = this->env().option("threads").as_integer();
+        CHECK_GT(threads, 0U) << "the number of threads must be positive";
+        CHECK(threads == 1 || mode == "naive") << "threads are only used in the naive mode";
+    }
 
     virtual void compress(Input& input, Output& output) override {
         // options
         size_t max_rules = env().option("max_rules").as_integer();
         if(max_rules == 0) max_rules = SIZE_MAX;
 
-        // prepare editable text
-        len_t n;
-        sym_t *text;
-        len_t *next; //TODO use an int vector of required bit width
-
-        {
-            auto view = input.as_view();
-            n = view.size();
-            text = new sym_t[n];
-            next = new len_t[n];
-
-            for(size_t i = 0; i < n; i++) {
-                text[i] = view[i];
-                next[i] = i + 1;
-            }
-        }
-
-        // compute RePair grammar
+        // compute RePair grammar, the text becomes the start rule
         grammar_t grammar;
-
-        size_t num_replaced = 0;
-
-        do {
-            // count digrams
-            digram_t max;
-            size_t max_count = 0;
-
+        const std::string mode = env().option("mode").as_string();
+        if(mode == "lean") {
+            DynamicIntVector text;
             {
-                std::unordered_map<digram_t, size_t> count;
-                // TODO: probably not optimal, but twice as fast as std::map
-
-                size_t i = 0;
-                while(i < n - 1) {
-                    size_t j = next[i];
-                    if(j >= n) break; // break if at end
-
-                    digram_t di = digram(text[i], text[j]);
-
-                    // update counter
-                    size_t c = count[di] + 1;
-                    count[di] = c;
-
-                    // update max
-                    if(c > max_count) {
-                        max = di;
-                        max_count = c;
-                    }
-
-                    // advance
-                    i = j;
-                }
+                auto view = input.as_view();
+                text = DynamicIntVector(view.size(), 0, 8);
+                for(size_t i = 0; i < view.size(); i++) text[i] = view[i];
             }
 
-            // replace most common digram (max)
-            if(max_count > 1) {
-                sym_t new_sym = sigma + grammar.size();
-                grammar.push_back(max);
-
-                size_t i = 0;
-                while(i < n - 1) {
-                    size_t j = next[i];
-                    if(j >= n) break; // break if at end
-
-                    digram_t di = digram(text[i], text[j]);
-                    if(di == max) {
-                        text[i] = new_sym; // replace symbol at i by new symbol
-                        next[i] = next[j];
-
-                        ++num_replaced;
-                    }
+            const size_t num_replaced = repair::lean_repair(text, grammar, max_rules);
+            encode(text, grammar, num_replaced, output);
+        } else {
+            std::vector<sym_t> text;
+            {
+                auto view = input.as_view();
+                text.assign(view.begin(), view.end());
+            }
 
-                    // advance
-                    i = next[i];
-                }
+            size_t num_replaced;
+            const size_t threads = env().option("threads").as_integer();
+            if(mode == "naive" && threads > 1) {
+                num_replaced = repair::parallel_repair(text, grammar, max_rules, threads);
+            } else if(mode == "naive") {
+                num_replaced = repair::naive_repair(text, grammar, max_rules);
             } else {
-                break; // done
+                num_replaced = repair::linear_repair(text, grammar, max_rules);
             }
-        } while(grammar.size() < max_rules);
+            encode(text, grammar, num_replaced, output);
+        }
+    }
 
+private:
+    template<typename text_t>
+    inline void encode(const text_t& text, const grammar_t& grammar,
+                       size_t num_replaced, Output& output) {
         // debug
         /*
         {
             DLOG(INFO) << "grammar:";
             for(size_t i = 0; i < grammar.size(); i++) {
                 digram_t di = grammar[i];
-                sym_t l = left(di);
-                sym_t r = right(di);
+                sym_t l = repair::left(di);
+                sym_t r = repair::right(di);
 
                 DLOG(INFO) << uint8_t('A' + i) << " -> " <<
                     uint8_t((l < sigma) ? l : ('A' + l - sigma)) <<
@@ -192,8 +168,7 @@ public:
             }
 
             std::ostringstream start;
-            for(size_t i = 0; i < n; i = next[i]) {
-                sym_t x = text[i];
+            for(sym_t x : text) {
                 start << uint8_t((x < sigma) ? x : ('A' + x - sigma));
             }
 
@@ -204,23 +179,83 @@ public:
         StatPhase::log("rules", grammar.size());
         StatPhase::log("replaced", num_replaced);
 
-        // instantiate encoder
-        typename coder_t::Encoder coder(env().env_for_option("coder"),
-            output, Literals<sym_t*>(text, n, next, grammar));
+        // statistics of the start rule
+        size_t num_text_terminals = 0;
+        size_t num_text_nonterminals = 0;
+        for(size_t i = 0; i < text.size(); i++) {
+            if(sym_t(text[i]) < sigma) ++num_text_terminals;
+            else ++num_text_nonterminals;
+        }
 
-        // encode amount of grammar rules
-        coder.encode(grammar.size(), len_r);
+        const size_t sample = env().option("sample").as_integer();
+        if(sample == 0) {
+            // instantiate encoder
+            typename coder_t::Encoder coder(env().env_for_option("coder"),
+                output, Literals<text_t>(text, grammar));
 
-        // lambda for encoding symbols
-        auto encode_sym = [&](sym_t x, const Range& r) {
-            if(x < sigma) {
-                coder.encode(false, bit_r);
-                coder.encode(x, literal_r);
-            } else {
-                coder.encode(true, bit_r);
-                coder.encode(x - sigma, r);
+            encode_grammar(coder, grammar);
+
+            // encode compressed text (start rule)
+            Range grammar_r(grammar.size());
+            for(size_t i = 0; i < text.size(); i++) {
+                encode_sym(coder, sym_t(text[i]), grammar_r);
             }
-        };
+        } else {
+            // the grammar is encoded in a frame of its own, such that the
+            // start rule behind it can be accessed at any position
+            std::vector<uint8_t> encoded;
+            {
+                const std::vector<sym_t> no_text;
+                Output out = Output::from_memory(encoded);
+                typename coder_t::Encoder coder(env().env_for_option("coder"),
+                    out, Literals<std::vector<sym_t>>(no_text, grammar));
+                encode_grammar(coder, grammar);
+            }
+
+            // the text positions of every sample-th symbol
+            repair::Expander expander(grammar, 0);
+            std::vector<size_t> samples;
+            size_t pos = 0;
+            for(size_t i = 0; i < text.size(); i++) {
+                if(i > 0 && i % sample == 0) samples.push_back(pos);
+                pos += expander.length(sym_t(text[i]));
+            }
+
+            auto ostream = output.as_stream();
+            write_vbyte(ostream, encoded.size());
+            ostream.write(reinterpret_cast<const char*>(encoded.data()), encoded.size());
+            write_vbyte(ostream, text.size());
+            write_vbyte(ostream, pos);
+
+            BitOStream bits(std::move(ostream));
+            const size_t pos_bits = bits_for(pos);
+            for(size_t p : samples) bits.write_int(p, pos_bits);
+
+            const size_t sym_bits = bits_for(sigma + grammar.size() - 1);
+            for(size_t i = 0; i < text.size(); i++) {
+                bits.write_int(sym_t(text[i]), sym_bits);
+            }
+        }
+
+        StatPhase::log("text_terms", num_text_terminals);
+        StatPhase::log("text_nonterms", num_text_nonterminals);
+    }
+
+    template<typename encoder_t>
+    inline static void encode_sym(encoder_t& coder, sym_t x, const Range& r) {
+        if(x < sigma) {
+            coder.encode(false, bit_r);
+            coder.encode(x, literal_r);
+        } else {
+            coder.encode(true, bit_r);
+            coder.encode(x - sigma, r);
+        }
+    }
+
+    template<typename encoder_t>
+    inline static void encode_grammar(encoder_t& coder, const grammar_t& grammar) {
+        // encode amount of grammar rules
+        coder.encode(grammar.size(), len_r);
 
         // encode grammar rules
         size_t num_grammar_terminals = 0;
@@ -232,93 +267,152 @@ public:
             Range grammar_r(i);
 
             // statistics
-            sym_t l = left(di);
+            sym_t l = repair::left(di);
             if(l < sigma) ++num_grammar_terminals;
             else ++num_grammar_nonterminals;
 
-            sym_t r = right(di);
+            sym_t r = repair::right(di);
             if(r < sigma) ++num_grammar_terminals;
             else ++num_grammar_nonterminals;
 
-            encode_sym(l, grammar_r);
-            encode_sym(r, grammar_r);
+            encode_sym(coder, l, grammar_r);
+            encode_sym(coder, r, grammar_r);
         }
 
         StatPhase::log("grammar_terms", num_grammar_terminals);
         StatPhase::log("grammar_nonterms", num_grammar_nonterminals);
+    }
 
-        // encode compressed text (start rule)
-        size_t num_text_terminals = 0;
-        size_t num_text_nonterminals = 0;
+    template<typename decoder_t>
+    inline static sym_t decode_sym(decoder_t& decoder, const Range& r) {
+        bool is_nonterminal = decoder.template decode<bool>(bit_r);
+        if(is_nonterminal) {
+            auto dec = decoder.template decode<sym_t>(r);
+            return sigma + dec;
+        } else {
+            auto dec = sym_t(decoder.template decode<uliteral_t>(literal_r));
+            return dec;
+        }
+    }
 
-        Range grammar_r(grammar.size());
-        for(size_t i = 0; i < n; i = next[i]) {
-            sym_t x = text[i];
+    template<typename decoder_t>
+    inline static grammar_t decode_grammar(decoder_t& decoder) {
+        grammar_t grammar;
+        auto num_rules = decoder.template decode<size_t>(len_r);
+        while(num_rules--) {
+            Range grammar_r(grammar.size());
+            sym_t l = decode_sym(decoder, grammar_r);
+            sym_t r = decode_sym(decoder, grammar_r);
+            grammar.push_back(repair::digram(l, r));
+        }
+        return grammar;
+    }
 
-            // statistics
-            if(x < sigma) ++num_text_terminals;
-            else ++num_text_nonterminals;
+    /// The start rule stored with a fixed width behind the grammar, if the
+    /// positions of the start rule are sampled.
+    class StartRule {
+        View m_bits;
+        size_t m_size;
+        size_t m_length; //! the length of the text
+        size_t m_num_samples;
+        size_t m_pos_bits;
+        size_t m_sym_bits;
+
+        /// Reads `bits` bits at the bit position `pos`, which are stored
+        /// with the highest bit first like by \ref BitOStream.
+        inline uint64_t read(size_t pos, size_t bits) const {
+            uint64_t v = 0;
+            for(size_t i = pos; i < pos + bits; ++i) {
+                v = (v << 1) | ((m_bits[i / 8] >> (7 - i % 8)) & 1);
+            }
+            return v;
+        }
 
-            encode_sym(text[i], grammar_r);
+    public:
+        /// Reads the header of the start rule behind the grammar, which
+        /// consists of `num_rules` rules.
+        inline StartRule(View data, size_t num_rules, size_t sample) {
+            const uint8_t* in = data.data();
+            const uint8_t* end = in + data.size();
+            m_size = read_vbyte<size_t>(in, end);
+            m_length = read_vbyte<size_t>(in, end);
+            m_bits = View(in, end - in);
+
+            m_num_samples = (m_size > 0) ? (m_size - 1) / sample : 0;
+            m_pos_bits = bits_for(m_length);
+            m_sym_bits = bits_for(sigma + num_rules - 1);
+            if(m_size > m_bits.size() * 8 / m_sym_bits ||
+               m_num_samples * m_pos_bits + m_size * m_sym_bits > m_bits.size() * 8) {
+                throw std::runtime_error("truncated start rule");
+            }
         }
 
-        StatPhase::log("text_terms", num_text_terminals);
-        StatPhase::log("text_nonterms", num_text_nonterminals);
+        /// The number of symbols of the start rule.
+        inline size_t size() const {
+            return m_size;
+        }
 
-        // clean up
-        delete[] next;
-        delete[] text;
-    }
+        /// The text position of the k-th sampled symbol.
+        inline size_t sample(size_t k) const {
+            return (k == 0) ? 0 : read((k - 1) * m_pos_bits, m_pos_bits);
+        }
 
-private:
-    inline static void decode(sym_t x, const grammar_t& grammar, std::ostream& ostream) {
-        if(x < sigma) {
-            // terminal
-            ostream << uliteral_t(x);
-        } else {
-            // non-terminal
-            digram_t di = grammar[x - sigma];
-            decode(left(di),  grammar, ostream);
-            decode(right(di), grammar, ostream);
+        /// The number of sampled symbols, including the first one.
+        inline size_t num_samples() const {
+            return m_num_samples + 1;
+        }
+
+        /// The i-th symbol of the start rule.
+        inline sym_t operator[](size_t i) const {
+            return sym_t(read(m_num_samples * m_pos_bits + i * m_sym_bits, m_sym_bits));
         }
+    };
+
+    /// Decodes the grammar of the frame at the beginning of the data and
+    /// returns the data behind it.
+    inline View decode_grammar_frame(View data, grammar_t& grammar) {
+        const uint8_t* in = data.data();
+        const uint8_t* end = in + data.size();
+        const size_t size = read_vbyte<size_t>(in, end);
+        if(size > size_t(end - in)) throw std::runtime_error("truncated grammar");
+
+        Input frame(View(in, size));
+        typename coder_t::Decoder decoder(env().env_for_option("coder"), frame);
+        grammar = decode_grammar(decoder);
+        return View(in + size, end - in - size);
     }
 
 public:
     virtual void decompress(Input& input, Output& output) override {
+        const size_t sample = env().option("sample").as_integer();
+        if(sample > 0) {
+            auto view = input.as_view();
+            grammar_t grammar;
+            const View rest = decode_grammar_frame(view, grammar);
+            const StartRule start(rest, grammar.size(), sample);
+
+            repair::Expander expander(grammar);
+            auto ostream = output.as_stream();
+            for(size_t i = 0; i < start.size(); i++) {
+                expander.expand(start[i], ostream);
+            }
+            expander.flush(ostream);
+            return;
+        }
+
         // instantiate decoder
         typename coder_t::Decoder decoder(env().env_for_option("coder"), input);
 
-        // lambda for decoding symbols
-        auto decode_sym = [&](const Range& r) {
-            bool is_nonterminal = decoder.template decode<bool>(bit_r);
-            if(is_nonterminal) {
-                auto dec = decoder.template decode<sym_t>(r);
-                return sigma + dec;
-            } else {
-                auto dec = sym_t(decoder.template decode<uliteral_t>(literal_r));
-                return dec;
-            }
-        };
-
         // decode grammar
-        grammar_t grammar;
-        {
-            auto num_rules = decoder.template decode<size_t>(len_r);
-            while(num_rules--) {
-                Range grammar_r(grammar.size());
-                sym_t l = decode_sym(grammar_r);
-                sym_t r = decode_sym(grammar_r);
-                grammar.push_back(digram(l, r));
-            }
-        }
+        const grammar_t grammar = decode_grammar(decoder);
 
         // debug
         /*{
             DLOG(INFO) << "decoded grammar:";
             for(size_t i = 0; i < grammar.size(); i++) {
                 digram_t di = grammar[i];
-                sym_t l = left(di);
-                sym_t r = right(di);
+                sym_t l = repair::left(di);
+                sym_t r = repair::right(di);
 
                 DLOG(INFO) << uint8_t('A' + i) << " -> " <<
                     uint8_t((l < sigma) ? l : ('A' + l - sigma)) <<
@@ -328,11 +422,70 @@ public:
 
         // decode text
         Range grammar_r(grammar.size());
+        repair::Expander expander(grammar);
 
         auto ostream = output.as_stream();
         while(!decoder.eof()) {
-            decode(decode_sym(grammar_r), grammar, ostream);
+            expander.expand(decode_sym(decoder, grammar_r), ostream);
+        }
+        expander.flush(ostream);
+    }
+
+    /// Extracts the part [from, to) of the text by descending the grammar.
+    ///
+    /// Only the symbols of the start rule that overlap the part are
+    /// expanded. If the positions of the start rule are sampled, the start
+    /// rule is read from the last sample at or before `from` on, such that
+    /// only the symbols from there up to the last one overlapping the part
+    /// are looked at. Otherwise, the start rule is decoded up to the part.
+    virtual void extract(Input& input, Output& output, size_t from, size_t to) override {
+        const size_t sample = env().option("sample").as_integer();
+        if(sample == 0) {
+            typename coder_t::Decoder decoder(env().env_for_option("coder"), input);
+            const grammar_t grammar = decode_grammar(decoder);
+            repair::Expander expander(grammar, 0);
+
+            Range grammar_r(grammar.size());
+            auto ostream = output.as_stream();
+            for(size_t pos = 0; pos < to && !decoder.eof();) {
+                const sym_t x = decode_sym(decoder, grammar_r);
+                const size_t len = expander.length(x);
+                if(pos + len > from) {
+                    expander.extract(x, (from > pos) ? from - pos : 0, to - pos, ostream);
+                }
+                pos += len;
+            }
+            expander.flush(ostream);
+            return;
+        }
+
+        auto view = input.as_view();
+        grammar_t grammar;
+        const View rest = decode_grammar_frame(view, grammar);
+        const StartRule start(rest, grammar.size(), sample);
+        repair::Expander expander(grammar, 0);
+
+        // find the last sample at or before from
+        size_t lo = 0;
+        size_t hi = start.num_samples();
+        while(hi - lo > 1) {
+            const size_t k = (lo + hi) / 2;
+            if(start.sample(k) <= from) lo = k;
+            else hi = k;
+        }
+
+        // expand the overlapping symbols
+        auto ostream = output.as_stream();
+        size_t pos = start.sample(lo);
+        for(size_t i = lo * sample; pos < to && i < start.size(); i++) {
+            const sym_t x = start[i];
+            const size_t len = expander.length(x);
+            if(pos + len > from) {
+                expander.extract(x, (from > pos) ? from - pos : 0, to - pos, ostream);
+            }
+            pos += len;
         }
+        expander.flush(ostream);
     }
 };
 
@@ -1,12 +1,76 @@
 #pragma once
 
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
 #include <tudocomp/util.hpp>
 #include <tudocomp/util/vbyte.hpp>
 #include <tudocomp/Env.hpp>
 #include <tudocomp/Compressor.hpp>
+#include <tudocomp/io/BlockReader.hpp>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
 namespace tdc {
 
+namespace rle {
+
+/// Returns the first position i in [from, n - 1) with in[i] = in[i + 1],
+/// or n if there is none. With SSE2, 16 positions are compared at once.
+inline size_t find_pair(const uliteral_t* in, size_t from, const size_t n) {
+	size_t i = from;
+#ifdef __SSE2__
+	for(; i + 17 <= n; i += 16) {
+		const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+		const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i + 1));
+		const uint32_t mask = _mm_movemask_epi8(_mm_cmpeq_epi8(a, b));
+		if(mask != 0) return i + __builtin_ctz(mask);
+	}
+#endif
+	for(; i + 1 < n; ++i) {
+		if(in[i] == in[i + 1]) return i;
+	}
+	return n;
+}
+
+/// Returns the first position i >= from with in[i] != c, or n if there is
+/// none. With SSE2, 16 positions are compared at once.
+inline size_t run_end(const uliteral_t* in, size_t from, const size_t n, const uliteral_t c) {
+	size_t i = from;
+#ifdef __SSE2__
+	const __m128i v = _mm_set1_epi8(c);
+	for(; i + 16 <= n; i += 16) {
+		const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+		const uint32_t mask = _mm_movemask_epi8(_mm_cmpeq_epi8(a, v)) ^ 0xFFFF;
+		if(mask != 0) return i + __builtin_ctz(mask);
+	}
+#endif
+	while(i < n && in[i] == c) ++i;
+	return i;
+}
+
+/// Writes a run of `length` >= 1 characters c to `out`.
+/// \return the number of bytes written
+inline size_t write_run(uliteral_t* out, const uliteral_t c, const size_t length, const size_t offset) {
+	out[0] = c;
+	if(length == 1) return 1;
+	out[1] = c;
+	return 2 + write_vbyte(out + 2, length - 2 + offset);
+}
+
+/// The maximum number of bytes the run length encoding of n characters
+/// takes, for any offset.
+inline size_t max_encoded_size(const size_t n) {
+	// each run of at least two characters is followed by a vbyte of at
+	// most 10 bytes
+	return n + (n / 2 + 1) * 10;
+}
+
+} //ns rle
+
 /**
  * Encode a byte-stream with run length encoding
  * each run of the same character is substituted with two occurrences of the same character and the length of the run minus two,
@@ -30,6 +94,147 @@ void rle_encode(std::basic_istream<char_type>& is, std::basic_ostream<char_type>
 		prev = c;
 	}
 }
+
+/**
+ * Encodes the n characters of `in` with run length encoding, like the
+ * stream-based rle_encode, into `out`, which needs room for
+ * rle::max_encoded_size(n) bytes (3n/2 + 1 bytes suffice if the offset is 0).
+ * \return the number of bytes written
+ */
+inline size_t rle_encode(const uliteral_t* in, size_t n, uliteral_t* out, size_t offset = 0) {
+	size_t w = 0;
+	for(size_t i = 0; i < n;) {
+		// the characters before the next run are copied as a whole
+		const size_t k = rle::find_pair(in, i, n);
+		std::memcpy(out + w, in + i, k - i);
+		w += k - i;
+		if(k == n) break;
+
+		const size_t j = rle::run_end(in, k + 2, n, in[k]);
+		w += rle::write_run(out + w, in[k], j - k, offset);
+		i = j;
+	}
+	return w;
+}
+
+/**
+ * Encodes the input read by `in` with run length encoding, like the
+ * stream-based rle_encode.
+ *
+ * The input is encoded in chunks. The run at the end of a chunk is held
+ * back, since it may continue in the next one.
+ */
+inline void rle_encode(io::BlockReader& in, std::ostream& os, size_t offset = 0) {
+	static constexpr size_t chunk_size = io::BlockReader::default_block_size;
+	std::vector<uliteral_t> out(rle::max_encoded_size(chunk_size) + 16);
+
+	uliteral_t c = 0;
+	size_t run = 0; //! the length of the held back run of c
+
+	for(View block = in.next_block(); !block.empty(); block = in.next_block()) {
+		for(size_t begin = 0; begin < block.size(); begin += chunk_size) {
+			const uliteral_t* chunk = block.data() + begin;
+			const size_t n = std::min(block.size() - begin, chunk_size);
+			size_t w = 0;
+
+			size_t i = 0;
+			if(run > 0) {
+				i = rle::run_end(chunk, 0, n, c);
+				run += i;
+				if(i == n) continue;
+				w += rle::write_run(out.data(), c, run, offset);
+			}
+
+			// hold back the run at the end of the chunk
+			size_t t = n - 1;
+			while(t > i && chunk[t - 1] == chunk[n - 1]) --t;
+			c = chunk[n - 1];
+			run = n - t;
+
+			w += rle_encode(chunk + i, t - i, out.data() + w, offset);
+			os.write(reinterpret_cast<const char*>(out.data()), w);
+		}
+	}
+
+	if(run > 0) {
+		const size_t w = rle::write_run(out.data(), c, run, offset);
+		os.write(reinterpret_cast<const char*>(out.data()), w);
+	}
+}
+
+/**
+ * Decodes the n run length encoded bytes of `in` into `out`, which has
+ * room for `capacity` characters.
+ * \return the number of decoded characters
+ */
+inline size_t rle_decode(const uliteral_t* in, size_t n, uliteral_t* out, size_t capacity, size_t offset = 0) {
+	const uliteral_t* end = in + n;
+	size_t w = 0;
+	while(in < end) {
+		// the characters up to the next run are copied as a whole
+		const size_t k = rle::find_pair(in, 0, end - in);
+		const size_t num = std::min(k + 1, size_t(end - in));
+		if(num > capacity - w) throw std::runtime_error("run length encoded data too long");
+		std::memcpy(out + w, in, num);
+		w += num;
+		in += num;
+		if(in == end) break;
+
+		const uliteral_t c = *in++;
+		const size_t run = read_vbyte<size_t>(in, end);
+		if(run < offset || run - offset >= capacity - w) {
+			throw std::runtime_error("run length encoded data too long");
+		}
+		std::memset(out + w, c, run - offset + 1);
+		w += run - offset + 1;
+	}
+	return w;
+}
+
+/**
+ * Decodes the n run length encoded bytes of `in` to the output stream.
+ * The text is collected in a buffer that is written in chunks.
+ */
+inline void rle_decode(const uliteral_t* in, size_t n, std::ostream& os, size_t offset = 0) {
+	static constexpr size_t chunk_size = io::BlockReader::default_block_size;
+	uliteral_t out[chunk_size];
+	size_t w = 0;
+
+	// appends m characters, copied from p or, if p is null, equal to c
+	auto append = [&](const uliteral_t* p, uliteral_t c, size_t m) {
+		while(m > 0) {
+			const size_t num = std::min(m, chunk_size - w);
+			if(p) {
+				std::memcpy(out + w, p, num);
+				p += num;
+			} else {
+				std::memset(out + w, c, num);
+			}
+			w += num;
+			m -= num;
+			if(w == chunk_size) {
+				os.write(reinterpret_cast<const char*>(out), w);
+				w = 0;
+			}
+		}
+	};
+
+	const uliteral_t* end = in + n;
+	while(in < end) {
+		const size_t k = rle::find_pair(in, 0, end - in);
+		const size_t num = std::min(k + 1, size_t(end - in));
+		append(in, 0, num);
+		in += num;
+		if(in == end) break;
+
+		const uliteral_t c = *in++;
+		const size_t run = read_vbyte<size_t>(in, end);
+		if(run < offset) throw std::runtime_error("invalid run length");
+		append(nullptr, c, run - offset + 1);
+	}
+	os.write(reinterpret_cast<const char*>(out), w);
+}
+
 /**
  * Decodes a run length encoded stream
  */
@@ -62,14 +267,14 @@ public:
     }
 
     inline virtual void compress(Input& input, Output& output) override {
-		auto is = input.as_stream();
+		io::BlockReader is(input);
 		auto os = output.as_stream();
 		rle_encode(is,os,m_offset);
 	}
     inline virtual void decompress(Input& input, Output& output) override {
-		auto is = input.as_stream();
+		auto in = input.as_view();
 		auto os = output.as_stream();
-		rle_decode(is,os,m_offset);
+		rle_decode(in.data(),in.size(),os,m_offset);
 	}
 };
 
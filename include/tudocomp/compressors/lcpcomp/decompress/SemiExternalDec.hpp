@@ -0,0 +1,230 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <unistd.h>
+#include <vector>
+#include <tudocomp/def.hpp>
+#include <tudocomp/Algorithm.hpp>
+#include <tudocomp/io/MMapHandle.hpp>
+
+#include <tudocomp_stat/StatPhase.hpp>
+
+namespace tdc {
+namespace lcpcomp {
+
+/**
+ * Decodes lcpcomp compressed data within a bounded amount of main memory.
+ * The text is restored in a memory mapped temporary file such that the kernel
+ * can write decoded pages back to disk instead of keeping them in RAM.
+ * Factors that cannot be decoded when they are read are kept in a run buffer
+ * whose size is given by the "budget" option (in MiB). A full run buffer is
+ * spilled to a temporary file.
+ * The pending factors are resolved in passes: each pass reads the runs,
+ * sorts each run by source position to access the mapped text sequentially,
+ * copies all characters that are already decoded and keeps the undecoded rest
+ * of each factor for the next pass.
+ */
+class SemiExternalDec : public Algorithm {
+public:
+    inline static Meta meta() {
+        Meta m("lcpcomp_dec", "external");
+        m.option("budget").dynamic(64);
+        return m;
+    }
+
+private:
+    struct Factor {
+        len_t target;
+        len_t source;
+        len_t length;
+    };
+
+    io::MMap m_map;
+    uliteral_t* m_buffer;
+    const len_t m_size;
+    len_t m_cursor;
+
+    size_t m_run_capacity;
+    std::vector<Factor> m_run; // pending factors kept in RAM
+    std::FILE* m_spill; // pending factors spilled to disk
+    size_t m_spilled; // number of factors stored in m_spill
+
+    len_t m_passes;
+
+    inline static std::string tmp_dir() {
+        const char* dir = std::getenv("TMPDIR");
+        return (dir != nullptr) ? dir : "/tmp";
+    }
+
+    inline void spill_run() {
+        if(m_spill == nullptr) {
+            // the spill file is unlinked right away, like the mapped text
+            std::string path = tmp_dir() + "/tudocomp_XXXXXX";
+            const int fd = mkstemp(&path[0]);
+            CHECK(fd != -1) << "Error at creating temporary file in " << tmp_dir();
+            unlink(path.c_str());
+
+            m_spill = fdopen(fd, "w+b");
+            CHECK(m_spill != nullptr) << "Error at opening temporary file";
+        }
+        const size_t written = std::fwrite(
+            m_run.data(), sizeof(Factor), m_run.size(), m_spill);
+        CHECK_EQ(written, m_run.size()) << "Error at spilling factors";
+
+        m_spilled += m_run.size();
+        m_run.clear();
+    }
+
+    inline void push_pending(const Factor& f) {
+        m_run.push_back(f);
+        if(m_run.size() >= m_run_capacity) spill_run();
+    }
+
+    /// Copies all decoded source characters of the factor and shrinks the
+    /// factor to its undecoded part. Returns the number of decoded characters.
+    inline len_t resolve(Factor& f) {
+        len_t decoded = 0;
+        len_t first = f.length;
+        len_t last = 0;
+
+        for(len_t i = 0; i < f.length; ++i) {
+            uliteral_t& t = m_buffer[f.target + i];
+            if(t) continue;
+
+            const uliteral_t c = m_buffer[f.source + i];
+            if(c) {
+                t = c;
+                ++decoded;
+            } else {
+                first = std::min(first, i);
+                last = i;
+            }
+        }
+
+        if(first == f.length) {
+            f.length = 0;
+        } else {
+            f.target += first;
+            f.source += first;
+            f.length = last - first + 1;
+        }
+        return decoded;
+    }
+
+    inline len_t resolve_run(std::vector<Factor>& run) {
+        std::sort(run.begin(), run.end(),
+            [](const Factor& a, const Factor& b) { return a.source < b.source; });
+
+        len_t decoded = 0;
+        for(Factor& f : run) {
+            decoded += resolve(f);
+            if(f.length > 0) push_pending(f);
+        }
+        return decoded;
+    }
+
+public:
+    inline SemiExternalDec(Env&& env, len_t size)
+        : Algorithm(std::move(env))
+        , m_map(io::MMap::temporary_file(size, tmp_dir()))
+        , m_buffer(m_map.view().data())
+        , m_size(size)
+        , m_cursor(0)
+        , m_spill(nullptr)
+        , m_spilled(0)
+        , m_passes(0)
+    {
+        // a pass holds the run it reads, the run it writes and the
+        // in-memory tail of the previous pass at the same time
+        const size_t budget = this->env().option("budget").as_integer() << 20;
+        m_run_capacity = std::max<size_t>(budget / (3 * sizeof(Factor)), 1);
+    }
+
+    inline SemiExternalDec(SemiExternalDec&& other)
+        : Algorithm(std::move(other))
+        , m_map(std::move(other.m_map))
+        , m_buffer(other.m_buffer)
+        , m_size(other.m_size)
+        , m_cursor(other.m_cursor)
+        , m_run_capacity(other.m_run_capacity)
+        , m_run(std::move(other.m_run))
+        , m_spill(other.m_spill)
+        , m_spilled(other.m_spilled)
+        , m_passes(other.m_passes)
+    {
+        other.m_spill = nullptr;
+    }
+
+    inline ~SemiExternalDec() {
+        if(m_spill != nullptr) std::fclose(m_spill);
+    }
+
+    inline void decode_literal(uliteral_t c) {
+        m_buffer[m_cursor++] = c;
+        DCHECK(c != 0 || m_cursor == m_size); // we assume that the text to restore does not contain a NULL-byte but at its very end
+    }
+
+    inline void decode_factor(const len_t source_position, const len_t factor_length) {
+        Factor f { m_cursor, source_position, factor_length };
+        resolve(f);
+        if(f.length > 0) push_pending(f);
+        m_cursor += factor_length;
+    }
+
+    inline void decode_lazy() const {
+    }
+
+    inline void decode_eagerly() {
+        std::vector<Factor> chunk;
+
+        while(m_spilled + m_run.size() > 0) {
+            ++m_passes;
+
+            // take the pending factors of the previous pass
+            std::FILE* in = m_spill;
+            size_t remaining = m_spilled;
+            std::vector<Factor> tail;
+            tail.swap(m_run);
+
+            m_spill = nullptr;
+            m_spilled = 0;
+
+            len_t decoded = 0;
+            if(in != nullptr) {
+                std::rewind(in);
+                while(remaining > 0) {
+                    chunk.resize(std::min(remaining, m_run_capacity));
+                    const size_t read = std::fread(
+                        chunk.data(), sizeof(Factor), chunk.size(), in);
+                    CHECK_EQ(read, chunk.size()) << "Error at reading spilled factors";
+
+                    remaining -= read;
+                    decoded += resolve_run(chunk);
+                }
+                std::fclose(in);
+            }
+            decoded += resolve_run(tail);
+
+            CHECK(decoded > 0 || m_spilled + m_run.size() == 0)
+                << "factors reference each other cyclically";
+        }
+
+        StatPhase::log("passes", m_passes);
+    }
+
+    /// Returns the number of passes needed to resolve all factors.
+    IF_STATS(
+    inline len_t longest_chain() const {
+        return m_passes;
+    })
+
+    inline void write_to(std::ostream& out) const {
+        out.write(reinterpret_cast<const char*>(m_buffer), m_size);
+    }
+};
+
+}} //ns
+
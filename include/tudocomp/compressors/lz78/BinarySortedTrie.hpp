@@ -7,7 +7,7 @@
 namespace tdc {
 namespace lz78 {
 
-class BinarySortedTrie : public Algorithm, public LZ78Trie<factorid_t> {
+class BinarySortedTrie : public Algorithm, public LZ78Trie<BinarySortedTrie> {
 	/*
 	 * The trie is not stored in standard form. Each node stores the pointer to its first child and a pointer to its next sibling (first as first come first served)
 	 */
@@ -28,18 +28,18 @@ public:
 		}
     }
 
-	node_t add_rootnode(uliteral_t c) override {
+	node_t add_rootnode(uliteral_t c) {
         first_child.push_back(undef_id);
 		next_sibling.push_back(undef_id);
 		literal.push_back(c);
 		return size() - 1;
 	}
 
-    node_t get_rootnode(uliteral_t c) override {
+    node_t get_rootnode(uliteral_t c) {
         return c;
     }
 
-	void clear() override {
+	void clear() {
         first_child.clear();
 		next_sibling.clear();
 		literal.clear();
@@ -53,7 +53,7 @@ public:
 		return undef_id;
 	}
 
-    node_t find_or_insert(const node_t& parent_w, uliteral_t c) override {
+    node_t find_or_insert(const node_t& parent_w, uliteral_t c) {
         auto parent = parent_w.id();
         const factorid_t newleaf_id = size(); //! if we add a new node, its index will be equal to the current size of the dictionary
 
@@ -87,7 +87,7 @@ public:
         return undef_id;
     }
 
-    factorid_t size() const override {
+    factorid_t size() const {
         return first_child.size();
     }
 };
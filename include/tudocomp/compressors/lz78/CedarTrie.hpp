@@ -55,7 +55,7 @@ const uint8_t NULL_ESCAPE_REPLACEMENT_BYTE = 254;
 
 const cedar_factorid_t HIDDEN_ESCAPE_ID = -3; // NOTE: May not be -1 or -2
 
-class CedarTrie: public Algorithm, public LZ78Trie<CedarSearchPos> {
+class CedarTrie: public Algorithm, public LZ78Trie<CedarTrie, CedarSearchPos> {
     // unique_ptr only needed for reassignment
     std::unique_ptr<cedar_t> m_trie;
     cedar_factorid_t m_ids = 0;
@@ -185,7 +185,7 @@ public:
         Algorithm(std::move(env)),
         m_trie(std::make_unique<cedar_t>()) {}
 
-    inline node_t add_rootnode(const uliteral_t c) override final {
+    inline node_t add_rootnode(const uliteral_t c) {
         cedar_factorid_t ids = c;
         DCHECK(m_ids == ids);
         m_ids++;
@@ -236,11 +236,11 @@ public:
         return r;
     }
 
-    inline node_t get_rootnode(uliteral_t c) override final {
+    inline node_t get_rootnode(uliteral_t c) {
         return node_t(c, m_roots.get(c));
     }
 
-    inline void clear() override final {
+    inline void clear() {
         // TODO: cedar seems to have a clear() method, but also
         // seems to have bugs in its implementation
         m_trie = std::make_unique<cedar_t>();
@@ -248,7 +248,7 @@ public:
         m_roots = LzwRootSearchPosMap();
     }
 
-    inline node_t find_or_insert(const node_t& parent, uliteral_t c) override final {
+    inline node_t find_or_insert(const node_t& parent, uliteral_t c) {
         node_t r;
         /*
         DLOG(INFO) << "find or insert "
@@ -272,7 +272,7 @@ public:
         return r;
     }
 
-    inline factorid_t size() const override final {
+    inline factorid_t size() const {
         return m_ids;
     }
 };
@@ -0,0 +1,224 @@
+#pragma once
+
+#include <unordered_map>
+#include <tudocomp/Algorithm.hpp>
+#include <tudocomp/ds/IntVector.hpp>
+#include <tudocomp/compressors/lz78/LZ78Trie.hpp>
+#include <tudocomp/compressors/lz78/squeeze_node.hpp>
+
+namespace tdc {
+namespace lz78 {
+
+/**
+ * A compact hash table (Cleary, "Compact Hash Tables Using Bidirectional
+ * Linear Probing", 1984) mapping squeezed trie nodes to factor ids.
+ *
+ * A key is mapped bijectively to a hash value of the same bit width.
+ * The lowest bits of the hash value address the home slot of the key, so a slot
+ * only has to store the remaining upper bits (the quotient).
+ * Collisions are resolved with linear probing; each slot stores its
+ * displacement to the home slot, from which the hash value and therefore
+ * the key can be restored. Small displacements are stored bit-packed,
+ * large ones in an overflow map.
+ */
+class CompactHash {
+    static constexpr uint8_t key_width = 40; //! a factor id with a literal
+    static constexpr uint64_t key_mask = (1ULL << key_width) - 1;
+    static constexpr uint8_t disp_width = 4;
+    static constexpr uint64_t disp_overflow = (1ULL << disp_width) - 1;
+    static constexpr uint8_t initial_bits = 4;
+
+    DynamicIntVector m_quotients;
+    DynamicIntVector m_displacements;
+    DynamicIntVector m_values; //! factor id + 1, 0 marks an empty slot
+    std::unordered_map<size_t, size_t> m_overflow; //! displacements >= disp_overflow
+
+    uint8_t m_bits; //! log2 of the table size
+    size_t m_entries;
+    const size_t m_load_factor; //! in percent
+
+    /// Bijective hash function on keys of `key_width` bits
+    inline static uint64_t hash(uint64_t key) {
+        key = (key ^ (key >> (key_width / 2))) & key_mask;
+        key = (key * 0x9E3779B97F4A7C15ULL) & key_mask;
+        key = key ^ (key >> (key_width / 2));
+        key = (key * 0xC2B2AE3D27D4EB4FULL) & key_mask;
+        return key ^ (key >> (key_width / 2));
+    }
+
+    inline size_t table_size() const {
+        return size_t(1) << m_bits;
+    }
+
+    inline size_t displacement(size_t pos) const {
+        const size_t d = m_displacements[pos];
+        return (d == disp_overflow) ? m_overflow.find(pos)->second : d;
+    }
+
+    inline size_t home_slot(size_t pos) const {
+        return (pos - displacement(pos)) & (table_size() - 1);
+    }
+
+    inline void allocate(uint8_t bits) {
+        m_bits = bits;
+        const size_t size = table_size();
+        m_quotients = DynamicIntVector(size, 0, key_width - m_bits);
+        m_displacements = DynamicIntVector(size, 0, disp_width);
+        m_values = DynamicIntVector(size, 0, bits_for(size));
+        m_overflow.clear();
+    }
+
+    /// Stores a value at the first free slot starting at the home slot of `h`.
+    inline void place(uint64_t h, uint64_t value) {
+        const size_t mask = table_size() - 1;
+        const size_t home = h & mask;
+
+        size_t pos = home;
+        while(m_values[pos] != 0) pos = (pos + 1) & mask;
+
+        const size_t disp = (pos - home) & mask;
+        m_quotients[pos] = h >> m_bits;
+        m_values[pos] = value;
+        if(disp < disp_overflow) {
+            m_displacements[pos] = disp;
+        } else {
+            m_displacements[pos] = disp_overflow;
+            m_overflow[pos] = disp;
+        }
+    }
+
+    inline void grow(uint8_t bits) {
+        DynamicIntVector quotients = std::move(m_quotients);
+        DynamicIntVector values = std::move(m_values);
+        DynamicIntVector displacements = std::move(m_displacements);
+        std::unordered_map<size_t, size_t> overflow = std::move(m_overflow);
+        const uint8_t old_bits = m_bits;
+        const size_t old_mask = table_size() - 1;
+
+        allocate(bits);
+        for(size_t pos = 0; pos <= old_mask; ++pos) {
+            const uint64_t value = values[pos];
+            if(value == 0) continue;
+
+            size_t disp = displacements[pos];
+            if(disp == disp_overflow) disp = overflow.find(pos)->second;
+
+            const uint64_t home = (pos - disp) & old_mask;
+            place((uint64_t(quotients[pos]) << old_bits) | home, value);
+        }
+    }
+
+public:
+    inline CompactHash(size_t load_factor)
+        : m_entries(0), m_load_factor(load_factor) {
+        DCHECK_GT(m_load_factor, 0);
+        DCHECK_LT(m_load_factor, 100);
+        allocate(initial_bits);
+    }
+
+    inline void reserve(size_t hint) {
+        uint8_t bits = m_bits;
+        while(hint * 100 >= (size_t(1) << bits) * m_load_factor) ++bits;
+        if(bits > m_bits) grow(bits);
+    }
+
+    inline void clear() {
+        m_entries = 0;
+        allocate(initial_bits);
+    }
+
+    inline size_t entries() const {
+        return m_entries;
+    }
+
+    /// Returns the value stored for `key`, or inserts `value` and returns
+    /// `undef_id` if the key is not yet in the table.
+    inline factorid_t find_or_insert(uint64_t key, factorid_t value) {
+        DCHECK_EQ(key & key_mask, key);
+        const uint64_t h = hash(key);
+        const size_t mask = table_size() - 1;
+        const size_t home = h & mask;
+        const uint64_t quotient = h >> m_bits;
+
+        size_t pos = home;
+        while(true) {
+            const uint64_t v = m_values[pos];
+            if(v == 0) break;
+            if(m_quotients[pos] == quotient && home_slot(pos) == home) {
+                return v - 1;
+            }
+            pos = (pos + 1) & mask;
+        }
+
+        ++m_entries;
+        if(tdc_unlikely(m_entries * 100 > table_size() * m_load_factor)) {
+            grow(m_bits + 1);
+            place(h, uint64_t(value) + 1);
+        } else {
+            m_quotients[pos] = quotient;
+            m_values[pos] = uint64_t(value) + 1;
+            const size_t disp = (pos - home) & mask;
+            if(disp < disp_overflow) {
+                m_displacements[pos] = disp;
+            } else {
+                m_displacements[pos] = disp_overflow;
+                m_overflow[pos] = disp;
+            }
+        }
+        return undef_id;
+    }
+};
+
+/**
+ * LZ78 trie based on a CompactHash.
+ * The root nodes are not stored in the table, since their keys would
+ * collide with the keys of the children of node 0.
+ */
+class CompactHashTrie : public Algorithm, public LZ78Trie<CompactHashTrie> {
+    CompactHash table;
+    factorid_t m_roots = 0;
+
+public:
+    inline static Meta meta() {
+        Meta m("lz78trie", "compact_hash", "Lempel-Ziv 78 Compact Hash Trie");
+        m.option("load_factor").dynamic(50);
+        return m;
+    }
+
+    CompactHashTrie(Env&& env, factorid_t reserve = 0)
+        : Algorithm(std::move(env))
+        , table(this->env().option("load_factor").as_integer()) {
+        if(reserve > 0) {
+            table.reserve(reserve);
+        }
+    }
+
+    node_t add_rootnode(uliteral_t) {
+        DCHECK_EQ(table.entries(), 0);
+        return m_roots++;
+    }
+
+    node_t get_rootnode(uliteral_t c) {
+        return c;
+    }
+
+    void clear() {
+        table.clear();
+        m_roots = 0;
+    }
+
+    node_t find_or_insert(const node_t& parent_w, uliteral_t c) {
+        // the table stores ids without the offset of the root nodes,
+        // so the id of a new leaf is the current number of entries
+        const factorid_t id = table.find_or_insert(
+            create_node(parent_w.id(), c), table.entries());
+        return (id == undef_id) ? undef_id : id + m_roots;
+    }
+
+    factorid_t size() const {
+        return m_roots + table.entries();
+    }
+};
+
+}} //ns
+
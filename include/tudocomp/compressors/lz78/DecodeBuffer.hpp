@@ -0,0 +1,173 @@
+#pragma once
+
+#include <algorithm>
+#include <cstring>
+#include <ostream>
+#include <vector>
+#include <tudocomp/def.hpp>
+#include <tudocomp/compressors/lz78/LZ78Trie.hpp>
+
+namespace tdc {
+namespace lz78 {
+
+/**
+ * The decoded text of LZ78 or LZW, in which each dictionary entry is stored
+ * as the position (offset, length) of one of its occurrences.
+ * A factor is restored by copying the string of its entry to the end of the
+ * text, instead of following the parent pointers of the entry.
+ *
+ * The text is written to the output in large blocks. If the dictionary is
+ * reset, the text is dropped. If the dictionary is pruned or frozen, the
+ * strings of the remaining entries are compacted to the front of the text;
+ * once frozen, only this compacted part is kept.
+ */
+class DecodeBuffer {
+    static constexpr size_t write_threshold = 1ULL << 20;
+    static constexpr size_t keep_all = size_t(-1);
+
+    const factorid_t m_roots;
+    std::vector<uliteral_t> m_text;
+    std::vector<size_t> m_offset; //! indexed by entry id
+    std::vector<factorid_t> m_length; //! indexed by entry id
+    size_t m_written; //! m_text[m_written..] has not been written to the output
+    size_t m_keep; //! m_text[m_keep..] can be dropped once it is written
+
+    /// Stores the strings of the root nodes, which are not part of the output.
+    inline void init_roots() {
+        m_text.clear();
+        m_offset.clear();
+        m_length.clear();
+        if(m_roots == 1) { // LZ78: the empty string
+            m_offset.push_back(0);
+            m_length.push_back(0);
+        } else { // LZW: one root per literal
+            for(factorid_t c = 0; c < m_roots; ++c) {
+                m_text.push_back(c);
+                m_offset.push_back(c);
+                m_length.push_back(1);
+            }
+        }
+        m_written = m_text.size();
+        m_keep = keep_all;
+    }
+
+public:
+    inline DecodeBuffer(factorid_t roots) : m_roots(roots) {
+        init_roots();
+    }
+
+    inline size_t size() const {
+        return m_text.size();
+    }
+
+    inline factorid_t length(factorid_t id) const {
+        return m_length[id];
+    }
+
+    inline uliteral_t first_literal(factorid_t id) const {
+        DCHECK_GT(m_length[id], 0);
+        return m_text[m_offset[id]];
+    }
+
+    inline void append(uliteral_t c) {
+        m_text.push_back(c);
+    }
+
+    /// Appends the string of entry `id`.
+    inline void append(factorid_t id) {
+        const size_t src = m_offset[id];
+        const size_t len = m_length[id];
+        const size_t dst = m_text.size();
+        m_text.resize(dst + len);
+
+        uliteral_t* text = m_text.data();
+        if(src + len <= dst) {
+            std::memcpy(text + dst, text + src, len);
+        } else {
+            // LZW: the entry ends with the first character of itself
+            for(size_t i = 0; i < len; ++i) text[dst + i] = text[src + i];
+        }
+    }
+
+    /// Sets the position of entry `id`, which is either the next entry
+    /// or an entry that was already set.
+    /// For LZW, the last character of an entry may lie beyond the text.
+    inline void set_entry(factorid_t id, size_t offset, factorid_t length) {
+        DCHECK_LE(id, m_offset.size());
+        if(id == m_offset.size()) {
+            m_offset.push_back(offset);
+            m_length.push_back(length);
+        } else {
+            m_offset[id] = offset;
+            m_length[id] = length;
+        }
+    }
+
+    /// Sets the last character of entry `id`, unless it lies beyond the
+    /// text, where the next factor will write it.
+    inline void set_last_literal(factorid_t id, uliteral_t c) {
+        const size_t pos = m_offset[id] + m_length[id] - 1;
+        if(pos < m_text.size()) m_text[pos] = c;
+    }
+
+    /// Writes the pending text to the output.
+    inline void flush(std::ostream& out) {
+        out.write(reinterpret_cast<const char*>(m_text.data() + m_written),
+                  m_text.size() - m_written);
+        m_written = m_text.size();
+
+        if(m_keep != keep_all) {
+            m_text.resize(m_keep);
+            m_written = m_keep;
+        }
+    }
+
+    /// Writes the pending text to the output if it is large enough.
+    inline void flush_if_full(std::ostream& out) {
+        if(m_text.size() - m_written >= write_threshold) flush(out);
+    }
+
+    /// Drops all entries after the dictionary was reset.
+    inline void reset(std::ostream& out) {
+        flush(out);
+        init_roots();
+    }
+
+    /// Moves the strings of the remaining entries to the front of the text.
+    /// \param entries the number of entries before the dictionary changed
+    /// \param renumbered maps an entry id to its new id, or to `undef_id`
+    ///        if the entry was removed
+    /// \param frozen whether the dictionary is frozen
+    template<class F>
+    inline void compact(std::ostream& out, factorid_t entries, F renumbered, bool frozen) {
+        flush(out);
+
+        std::vector<uliteral_t> text;
+        std::vector<size_t> offset;
+        std::vector<factorid_t> length;
+        std::swap(text, m_text);
+        std::swap(offset, m_offset);
+        std::swap(length, m_length);
+        init_roots();
+
+        for(factorid_t id = m_roots; id < entries; ++id) {
+            const factorid_t new_id = renumbered(id);
+            if(new_id == undef_id) continue;
+            DCHECK_EQ(new_id, m_offset.size());
+
+            m_offset.push_back(m_text.size());
+            m_length.push_back(length[id]);
+
+            // the pending entry of LZW lacks its last character
+            const size_t available = std::min<size_t>(length[id], text.size() - offset[id]);
+            m_text.insert(m_text.end(), text.begin() + offset[id], text.begin() + offset[id] + available);
+            m_text.resize(m_text.size() + length[id] - available);
+        }
+
+        m_written = m_text.size();
+        m_keep = frozen ? m_text.size() : keep_all;
+    }
+};
+
+}} //ns
+
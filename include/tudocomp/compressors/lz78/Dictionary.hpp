@@ -0,0 +1,250 @@
+#pragma once
+
+#include <algorithm>
+#include <type_traits>
+#include <vector>
+#include <tudocomp/def.hpp>
+#include <tudocomp/Env.hpp>
+#include <tudocomp/compressors/lz78/LZ78Trie.hpp>
+
+namespace tdc {
+namespace lz78 {
+
+#define LZ78_DICT_POLICY_DESC \
+			"`dict_policy` determines what happens once the dictionary\n" \
+			"reaches `dict_size` entries:\n" \
+			"`reset` starts over with an empty dictionary,\n" \
+			"`freeze` keeps the dictionary without adding entries, and\n" \
+			"`prune` removes the least recently used half of the entries."
+
+/// What to do if the dictionary reaches its maximum size.
+enum class DictPolicy { reset, freeze, prune };
+
+/// Reads the `dict_size` option, where "inf" or 0 mean unlimited.
+inline factorid_t dict_size_option(Env& env) {
+    auto& o = env.option("dict_size");
+    if (o.as_string() == "inf") {
+        return 0;
+    } else {
+        return o.as_integer();
+    }
+}
+
+/// Reads the `dict_policy` option.
+inline DictPolicy dict_policy_option(Env& env) {
+    const std::string policy = env.option("dict_policy").as_string();
+    if(policy == "reset") return DictPolicy::reset;
+    if(policy == "freeze") return DictPolicy::freeze;
+    if(policy == "prune") return DictPolicy::prune;
+    CHECK(false) << "unknown dictionary policy \"" << policy << "\"";
+    return DictPolicy::reset;
+}
+
+/**
+ * The dictionary of LZ78 or LZW as a list of entries (parent id, literal),
+ * where the first `roots` ids are reserved for the root nodes.
+ *
+ * Compressor and decompressor both keep a Dictionary and feed it with the
+ * same entries, such that both apply the dictionary policy at the same time.
+ * The compressor only has to store the entries if it has to rebuild its trie
+ * from them (freeze and prune); otherwise the Dictionary just counts them.
+ *
+ * For pruning, each entry has a stamp, the number of the last factor it was
+ * part of. A factor only stamps the entry it refers to and its new entry.
+ * Before pruning, the stamps are propagated to the parents, such that the
+ * stamp of an entry is the last factor that used it or one of its extensions.
+ * Pruning keeps the entries whose stamp is larger than the median stamp;
+ * these form a subtree, which is renumbered in the order of the former ids.
+ */
+class Dictionary {
+public:
+    /// Result of `add`
+    enum class Event { none, reset, pruned };
+
+private:
+    DictPolicy m_policy;
+    factorid_t m_max_size; //! 0 == unlimited
+    factorid_t m_roots;
+    bool m_store;
+    bool m_frozen;
+    factorid_t m_size;
+
+    std::vector<factorid_t> m_parent;
+    std::vector<uliteral_t> m_literal;
+    std::vector<uint64_t> m_stamp;
+    std::vector<factorid_t> m_renumbering; //! old id -> new id of the last prune
+
+    inline void init() {
+        m_frozen = false;
+        m_size = m_roots;
+        if(m_store) {
+            m_parent.assign(m_roots, undef_id);
+            m_literal.resize(m_roots);
+            for(factorid_t i = 0; i < m_roots; ++i) m_literal[i] = i;
+            if(m_policy == DictPolicy::prune) m_stamp.assign(m_roots, 0);
+        }
+    }
+
+    inline void prune() {
+        DCHECK(m_store);
+
+        // children have larger ids than their parents
+        for(factorid_t id = m_size; id-- > m_roots;) {
+            const factorid_t parent = m_parent[id];
+            if(parent >= m_roots) m_stamp[parent] = std::max(m_stamp[parent], m_stamp[id]);
+        }
+
+        // keep the entries whose stamp exceeds the median
+        std::vector<uint64_t> stamps(m_stamp.begin() + m_roots, m_stamp.end());
+        const auto median = stamps.begin() + stamps.size() / 2;
+        std::nth_element(stamps.begin(), median, stamps.end());
+        const uint64_t threshold = *median;
+
+        m_renumbering.assign(m_size, undef_id);
+        for(factorid_t id = 0; id < m_roots; ++id) m_renumbering[id] = id;
+
+        factorid_t n = m_roots;
+        for(factorid_t id = m_roots; id < m_size; ++id) {
+            if(m_stamp[id] <= threshold) continue;
+            DCHECK_NE(m_renumbering[m_parent[id]], undef_id); // kept entries form a subtree
+
+            m_renumbering[id] = n;
+            m_parent[n] = m_renumbering[m_parent[id]];
+            m_literal[n] = m_literal[id];
+            m_stamp[n] = m_stamp[id];
+            ++n;
+        }
+
+        m_size = n;
+        m_parent.resize(n);
+        m_literal.resize(n);
+        m_stamp.resize(n);
+    }
+
+public:
+    /// \param store whether to store the entries. They are always stored
+    ///        if they are needed to apply the policy.
+    inline Dictionary(DictPolicy policy, factorid_t max_size, factorid_t roots, bool store, size_t reserve = 0)
+        : m_policy(policy)
+        , m_max_size(max_size)
+        , m_roots(roots)
+        , m_store(store || (max_size > 0 && policy != DictPolicy::reset))
+    {
+        CHECK(m_max_size == 0 || m_max_size > m_roots)
+            << "dict_size has to be larger than the number of root nodes (" << m_roots << ")";
+        if(m_store) {
+            if(m_max_size > 0) reserve = m_max_size;
+            m_parent.reserve(reserve);
+            m_literal.reserve(reserve);
+            if(m_policy == DictPolicy::prune) m_stamp.reserve(reserve);
+        }
+        init();
+    }
+
+    /// The number of entries, including the root nodes.
+    inline factorid_t size() const { return m_size; }
+
+    /// The maximum number of entries, or 0 if unlimited.
+    inline factorid_t max_size() const { return m_max_size; }
+
+    inline bool frozen() const { return m_frozen; }
+
+    inline factorid_t roots() const { return m_roots; }
+
+    inline factorid_t parent(factorid_t id) const {
+        DCHECK(m_store);
+        return m_parent[id];
+    }
+
+    inline uliteral_t literal(factorid_t id) const {
+        DCHECK(m_store);
+        return m_literal[id];
+    }
+
+    /// Marks the entry as used by the factor with the number `stamp`.
+    inline void touch(factorid_t id, uint64_t stamp) {
+        if(m_policy == DictPolicy::prune && m_store) m_stamp[id] = stamp;
+    }
+
+    /// Maps an id before the last prune to its current id,
+    /// or to `undef_id` if the entry was pruned.
+    inline factorid_t renumbered(factorid_t id) const {
+        return m_renumbering[id];
+    }
+
+    /// Adds the entry (`parent`, `c`) used by the factor with the number
+    /// `stamp`, unless the dictionary is frozen, and applies the policy
+    /// if the dictionary becomes full. The new entry gets the id `size()`.
+    inline Event add(factorid_t parent, uliteral_t c, uint64_t stamp) {
+        if(m_frozen) return Event::none;
+
+        if(m_store) {
+            m_parent.push_back(parent);
+            m_literal.push_back(c);
+            if(m_policy == DictPolicy::prune) m_stamp.push_back(stamp);
+        }
+        ++m_size;
+
+        if(m_size != m_max_size) return Event::none; // never happens if m_max_size == 0
+
+        switch(m_policy) {
+            case DictPolicy::reset:
+                init();
+                return Event::reset;
+            case DictPolicy::freeze:
+                m_frozen = true;
+                return Event::none;
+            case DictPolicy::prune:
+                prune();
+                return Event::pruned;
+        }
+        return Event::none;
+    }
+
+    /// Rebuilds `trie` such that it contains exactly the entries of this
+    /// dictionary with the same ids. The root nodes have to be added already.
+    template<class trie_t>
+    inline void rebuild(trie_t& trie) const {
+        DCHECK(m_store);
+        DCHECK_EQ(trie.size(), m_roots);
+
+        using node_t = typename trie_t::node_t;
+        for(factorid_t id = m_roots; id < m_size; ++id) {
+            const node_t inserted = trie.find_or_insert(node(trie, m_parent[id]), m_literal[id]);
+            DCHECK_EQ(inserted.id(), undef_id);
+            DCHECK_EQ(trie.size(), id + 1);
+        }
+    }
+
+private:
+    /// The node of entry `id` in a trie whose nodes are identified by their ids.
+    template<class trie_t>
+    inline typename std::enable_if<
+        std::is_same<typename trie_t::node_t, TrieNode<factorid_t>>::value,
+        typename trie_t::node_t>::type
+    node(trie_t&, factorid_t id) const {
+        return id;
+    }
+
+    /// The node of entry `id` in a trie with other node handles,
+    /// which might be invalidated by insertions (e.g., CedarTrie).
+    /// The node is searched from its root.
+    template<class trie_t>
+    inline typename std::enable_if<
+        !std::is_same<typename trie_t::node_t, TrieNode<factorid_t>>::value,
+        typename trie_t::node_t>::type
+    node(trie_t& trie, factorid_t id) const {
+        std::vector<factorid_t> path;
+        for(; id >= m_roots; id = m_parent[id]) path.push_back(id);
+
+        auto n = trie.get_rootnode(m_literal[id]);
+        for(size_t i = path.size(); i > 0; --i) {
+            n = trie.find_or_insert(n, m_literal[path[i - 1]]);
+            DCHECK_EQ(n.id(), path[i - 1]);
+        }
+        return n;
+    }
+};
+
+}} //ns
+
@@ -8,7 +8,7 @@
 namespace tdc {
 namespace lz78 {
 
-class HashTrie : public Algorithm, public LZ78Trie<factorid_t> {
+class HashTrie : public Algorithm, public LZ78Trie<HashTrie> {
     using squeze_node_t = ::tdc::lz78::node_t;
 	std::unordered_map<squeze_node_t, factorid_t> table;
 
@@ -24,21 +24,21 @@ public:
 		}
     }
 
-	node_t add_rootnode(uliteral_t c) override {
+	node_t add_rootnode(uliteral_t c) {
 		table.insert(std::make_pair<squeze_node_t,factorid_t>(create_node(0, c), size()));
 		return size() - 1;
 	}
 
-    node_t get_rootnode(uliteral_t c) override {
+    node_t get_rootnode(uliteral_t c) {
         return c;
     }
 
-	void clear() override {
+	void clear() {
 		table.clear();
 
 	}
 
-    node_t find_or_insert(const node_t& parent_w, uliteral_t c) override {
+    node_t find_or_insert(const node_t& parent_w, uliteral_t c) {
         auto parent = parent_w.id();
         const factorid_t newleaf_id = size(); //! if we add a new node, its index will be equal to the current size of the dictionary
 
@@ -47,7 +47,7 @@ public:
 		return ret.first->second; // return the factor id of that node
     }
 
-    factorid_t size() const override {
+    factorid_t size() const {
         return table.size();
     }
 };
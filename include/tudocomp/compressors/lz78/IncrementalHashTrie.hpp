@@ -0,0 +1,321 @@
+#pragma once
+
+#include <cstdlib>
+#include <memory>
+#include <tudocomp/Algorithm.hpp>
+#include <tudocomp/util/Hash.hpp>
+#include <tudocomp/compressors/lz78/LZ78Trie.hpp>
+#include <tudocomp/compressors/lz78/squeeze_node.hpp>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace tdc {
+namespace lz78 {
+
+/**
+ * A linear probing hash table mapping squeezed trie nodes to factor ids,
+ * without the stalls of a complete rehash.
+ *
+ * The slots are partitioned into groups of 16. Each slot has a one byte tag
+ * storing 7 bits of the hash value of its key, or 0 if the slot is empty. A lookup
+ * compares the 16 tags of a group at once (with SSE2 if available) and
+ * only compares the keys of matching tags. Groups are probed linearly;
+ * since nothing gets deleted, a group with an empty slot ends the search.
+ *
+ * When the table gets too full, a table with twice the number of groups
+ * becomes the active table, and the old table is kept for lookups.
+ * Each insertion then migrates `migrate_groups` groups of the old table,
+ * such that the migration is finished long before the new table is full.
+ */
+class IncrementalHash {
+    static constexpr size_t group_size = 16;
+    static constexpr uint8_t full_bit = 0x80; //! set in the tag of each non-empty slot
+    static constexpr size_t initial_groups = 1;
+    static constexpr size_t migrate_groups = 2;
+    static constexpr size_t max_load_num = 7; //! max. load factor is 7/8
+    static constexpr size_t max_load_den = 8;
+
+    struct FreeDeleter {
+        inline void operator()(void* p) const { std::free(p); }
+    };
+    template<class T>
+    using array_t = std::unique_ptr<T[], FreeDeleter>;
+
+    /// The arrays are allocated uninitialized (keys, values) or with calloc
+    /// (tags, empty slots have tag 0), such that growing the table does not
+    /// touch the new memory in one go; the pages are faulted in lazily.
+    struct Table {
+        array_t<uint8_t> tags;
+        array_t<uint64_t> keys;
+        array_t<factorid_t> values;
+        size_t group_mask = 0;
+        size_t size = 0;
+
+        template<class T>
+        inline static array_t<T> alloc(size_t n, bool zero) {
+            void* p = zero ? std::calloc(n, sizeof(T)) : std::malloc(n * sizeof(T));
+            CHECK(p != nullptr) << "Error at allocating the hash table";
+            return array_t<T>(static_cast<T*>(p));
+        }
+
+        inline void allocate(size_t groups) {
+            DCHECK_EQ(groups & (groups - 1), 0);
+            size = groups * group_size;
+            tags = alloc<uint8_t>(size, true);
+            keys = alloc<uint64_t>(size, false);
+            values = alloc<factorid_t>(size, false);
+            group_mask = groups - 1;
+        }
+
+        inline void release() {
+            tags.reset();
+            keys.reset();
+            values.reset();
+            group_mask = 0;
+            size = 0;
+        }
+
+        inline size_t groups() const {
+            return size / group_size;
+        }
+
+        inline size_t capacity() const {
+            return size;
+        }
+    };
+
+    Table m_table; //! receives all insertions
+    Table m_old;   //! read-only while it is migrated to m_table
+    size_t m_migrated; //! number of groups of m_old already migrated
+    size_t m_entries;
+
+    inline static uint64_t hash(uint64_t key) {
+        return MixHasher()(key);
+    }
+
+    inline static uint8_t tag_of(uint64_t h) {
+        return full_bit | (h >> 57);
+    }
+
+    /// Bit i is set iff slot i of the group has tag `tag`.
+    inline static uint32_t match(const uint8_t* group, uint8_t tag) {
+#ifdef __SSE2__
+        const __m128i tags = _mm_loadu_si128(reinterpret_cast<const __m128i*>(group));
+        return _mm_movemask_epi8(_mm_cmpeq_epi8(tags, _mm_set1_epi8(tag)));
+#else
+        uint32_t mask = 0;
+        for(size_t i = 0; i < group_size; ++i) {
+            mask |= uint32_t(group[i] == tag) << i;
+        }
+        return mask;
+#endif
+    }
+
+    /// Bit i is set iff slot i of the group is empty.
+    inline static uint32_t match_empty(const uint8_t* group) {
+#ifdef __SSE2__
+        // only the tags of non-empty slots have their highest bit set
+        return ~_mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(group))) & 0xFFFF;
+#else
+        return match(group, 0);
+#endif
+    }
+
+    inline static size_t lowest_bit(uint32_t mask) {
+        return __builtin_ctz(mask);
+    }
+
+    /// Searches `key` in `table`. Returns the slot of the key, or
+    /// the first empty slot of its probe sequence with `found` = false.
+    inline static size_t probe(const Table& table, uint64_t key, uint64_t h, bool& found) {
+        const uint8_t tag = tag_of(h);
+        size_t group = h & table.group_mask;
+        while(true) {
+            const size_t base = group * group_size;
+            const uint8_t* tags = table.tags.get() + base;
+
+            for(uint32_t m = match(tags, tag); m != 0; m &= m - 1) {
+                const size_t slot = base + lowest_bit(m);
+                if(table.keys[slot] == key) {
+                    found = true;
+                    return slot;
+                }
+            }
+
+            const uint32_t empty = match_empty(tags);
+            if(empty != 0) {
+                found = false;
+                return base + lowest_bit(empty);
+            }
+            group = (group + 1) & table.group_mask;
+        }
+    }
+
+    inline static void place(Table& table, uint64_t key, uint64_t h, factorid_t value, size_t slot) {
+        table.tags[slot] = tag_of(h);
+        table.keys[slot] = key;
+        table.values[slot] = value;
+    }
+
+    /// Inserts a key that is known not to be in `table`.
+    inline static void place(Table& table, uint64_t key, factorid_t value) {
+        const uint64_t h = hash(key);
+        size_t group = h & table.group_mask;
+        while(true) {
+            const size_t base = group * group_size;
+            const uint32_t empty = match_empty(table.tags.get() + base);
+            if(empty != 0) {
+                place(table, key, h, value, base + lowest_bit(empty));
+                return;
+            }
+            group = (group + 1) & table.group_mask;
+        }
+    }
+
+    inline bool migrating() const {
+        return m_old.capacity() > 0;
+    }
+
+    /// Moves up to `groups` groups of the old table to the active table.
+    inline void migrate(size_t groups) {
+        const size_t end = std::min(m_migrated + groups, m_old.groups());
+        for(size_t slot = m_migrated * group_size; slot < end * group_size; ++slot) {
+            if(m_old.tags[slot] != 0) {
+                place(m_table, m_old.keys[slot], m_old.values[slot]);
+            }
+        }
+        m_migrated = end;
+        if(m_migrated == m_old.groups()) {
+            m_old.release();
+        }
+    }
+
+    inline void finish_migration() {
+        if(migrating()) migrate(m_old.groups());
+    }
+
+    inline bool overloaded(size_t entries, size_t capacity) const {
+        return entries * max_load_den > capacity * max_load_num;
+    }
+
+    inline void start_resize() {
+        DCHECK(!migrating());
+        m_old = std::move(m_table);
+        m_table.allocate(m_old.groups() * 2);
+        m_migrated = 0;
+    }
+
+public:
+    inline IncrementalHash() : m_migrated(0), m_entries(0) {
+        m_table.allocate(initial_groups);
+    }
+
+    inline void reserve(size_t hint) {
+        size_t groups = m_table.groups();
+        while(overloaded(hint, groups * group_size)) groups *= 2;
+        if(groups == m_table.groups()) return;
+
+        finish_migration();
+        Table table;
+        table.allocate(groups);
+        for(size_t slot = 0; slot < m_table.capacity(); ++slot) {
+            if(m_table.tags[slot] != 0) {
+                place(table, m_table.keys[slot], m_table.values[slot]);
+            }
+        }
+        m_table = std::move(table);
+    }
+
+    inline void clear() {
+        m_old.release();
+        m_table.release();
+        m_table.allocate(initial_groups);
+        m_migrated = 0;
+        m_entries = 0;
+    }
+
+    inline size_t entries() const {
+        return m_entries;
+    }
+
+    /// Returns the value stored for `key`, or inserts `value` and returns
+    /// `undef_id` if the key is not yet in the table.
+    inline factorid_t find_or_insert(uint64_t key, factorid_t value) {
+        const uint64_t h = hash(key);
+
+        bool found;
+        const size_t slot = probe(m_table, key, h, found);
+        if(found) return m_table.values[slot];
+
+        if(tdc_unlikely(migrating())) {
+            // entries not yet migrated can only be found in the old table
+            bool found_old;
+            const size_t old_slot = probe(m_old, key, h, found_old);
+            if(found_old) return m_old.values[old_slot];
+        }
+
+        ++m_entries;
+        place(m_table, key, h, value, slot);
+
+        if(tdc_unlikely(migrating())) {
+            migrate(migrate_groups);
+        } else if(tdc_unlikely(overloaded(m_entries, m_table.capacity()))) {
+            start_resize();
+            migrate(migrate_groups);
+        }
+        return undef_id;
+    }
+};
+
+/**
+ * LZ78 trie based on an IncrementalHash.
+ * The root nodes are not stored in the table, since their keys would
+ * collide with the keys of the children of node 0.
+ */
+class IncrementalHashTrie : public Algorithm, public LZ78Trie<IncrementalHashTrie> {
+    IncrementalHash table;
+    factorid_t m_roots = 0;
+
+public:
+    inline static Meta meta() {
+        Meta m("lz78trie", "incremental_hash", "Lempel-Ziv 78 Incrementally Resized Hash Trie");
+        return m;
+    }
+
+    IncrementalHashTrie(Env&& env, factorid_t reserve = 0) : Algorithm(std::move(env)) {
+        if(reserve > 0) {
+            table.reserve(reserve);
+        }
+    }
+
+    node_t add_rootnode(uliteral_t) {
+        DCHECK_EQ(table.entries(), 0);
+        return m_roots++;
+    }
+
+    node_t get_rootnode(uliteral_t c) {
+        return c;
+    }
+
+    void clear() {
+        table.clear();
+        m_roots = 0;
+    }
+
+    node_t find_or_insert(const node_t& parent_w, uliteral_t c) {
+        // the table stores ids without the offset of the root nodes,
+        // so the id of a new leaf is the current number of entries
+        const factorid_t id = table.find_or_insert(
+            create_node(parent_w.id(), c), table.entries());
+        return (id == undef_id) ? undef_id : id + m_roots;
+    }
+
+    factorid_t size() const {
+        return m_roots + table.entries();
+    }
+};
+
+}} //ns
+
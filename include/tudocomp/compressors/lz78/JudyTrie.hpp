@@ -16,7 +16,7 @@ namespace lz78 {
 ///
 /// \sa http://www.cplusplus.com/articles/iL18T05o/
 ///
-class JudyTrie : public Algorithm, public LZ78Trie<factorid_t> {
+class JudyTrie : public Algorithm, public LZ78Trie<JudyTrie> {
 
 	Pvoid_t m_dict; // judy array
 	size_t m_size;
@@ -40,18 +40,18 @@ public:
 	{
     }
 
-    node_t get_rootnode(uliteral_t c) override {
+    node_t get_rootnode(uliteral_t c) {
         return create_node(0,c);
     }
 
-	node_t add_rootnode(uliteral_t c) override {
+	node_t add_rootnode(uliteral_t c) {
 		DCHECK_EQ(find(create_node(0, c)), 0);
 		find(create_node(0, c)) = size();
 		++m_size;
 		return size();
 	}
 
-	void clear() override {
+	void clear() {
 		if(m_dict != nullptr) {
 			int i;
 			JLFA(i, m_dict);
@@ -59,7 +59,7 @@ public:
 		m_size = 0;
 	}
 
-    node_t find_or_insert(const node_t& parent, uliteral_t c) override {
+    node_t find_or_insert(const node_t& parent, uliteral_t c) {
 		const node_t node = create_node(parent.id(), c);
 
 		factorid_t& id = find(node);
@@ -73,7 +73,7 @@ public:
 		return id-1;
     }
 
-    factorid_t size() const override {
+    factorid_t size() const {
         return m_size;
     }
 };
@@ -3,6 +3,8 @@
 #include <limits>
 #include <cstddef>
 #include <cstdint>
+#include <type_traits>
+#include <utility>
 #include <tudocomp/def.hpp>
 namespace tdc {
 namespace lz78 {
@@ -33,47 +35,66 @@ public:
 
 #define LZ78_DICT_SIZE_DESC \
 			"`dict_size` has to either be 0 (unlimited), or a positive integer,\n" \
-			"and determines the maximum size of the backing storage of\n" \
-			"the dictionary before it gets reset."
-
-template<typename search_pos>
+			"and determines the maximum number of dictionary entries,\n" \
+			"including the root nodes."
+
+/**
+ * Base class of all LZ78 tries, using the curiously recurring template pattern.
+ *
+ * The compressors take the trie type as a template parameter and call the
+ * trie methods on that type directly. The interface is therefore a static
+ * contract instead of a set of virtual methods, such that `find_or_insert`,
+ * which is called once per input character, can be inlined.
+ * A trie `trie_t` derives from `LZ78Trie<trie_t, search_pos>` and provides
+ * the following methods (checked at compile time):
+ *
+ * - `node_t add_rootnode(uliteral_t c)`
+ *   The dictionary can store multiple root nodes.
+ *   For LZ78, we use a root node with the id = c = 0.
+ *   For LZW, we add for each possible literal value a root node.
+ *   The compressor has to add these nodes.
+ *
+ * - `node_t get_rootnode(uliteral_t c)`
+ *   Returns the root node corresponding to literal c.
+ *
+ * - `void clear()`
+ *   Erases the contents of the dictionary.
+ *   Used by compressors with limited dictionary size.
+ *
+ * - `node_t find_or_insert(const node_t& parent, uliteral_t c)`
+ *   Searches a pair (`parent`, `c`). If there is no node below `parent` on
+ *   an edge labeled with `c`, a new leaf of the `parent` will be constructed.
+ *   Returns the respective child if it was found,
+ *   or a node with id `undef_id` if a new leaf was inserted.
+ *
+ * - `factorid_t size() const`
+ *   Returns the number of entries, plus the number of rootnodes.
+ */
+template<class trie_t, typename search_pos = factorid_t>
 class LZ78Trie {
 public:
     using node_t = TrieNode<search_pos>;
-protected:
-
-	/**
-	 * The dictionary can store multiple root nodes
-	 * For LZ78, we use a root node with the id = c = 0.
-	 * For LZW, we add for each possible literal value a root node.
-	 * The compressor has to add these nodes.
-	 */
-	virtual node_t add_rootnode(uliteral_t c) = 0;
-
-    /**
-     * Returns the root node corresponding to literal c
-     */
-    virtual node_t get_rootnode(uliteral_t c) = 0;
-
-	/**
-	 * Erases the contents of the dictionary.
-	 * Used by compressors with limited dictionary size.
-	 */
-	virtual void clear() = 0;
-
-    /** Searches a pair (`parent`, `c`). If there is no node below `parent` on an edge labeled with `c`, a new leaf of the `parent` will be constructed.
-      * @param parent  the parent node's id
-      * @param c       the edge label to follow
-      * @return the index of the respective child, if it was found.
-      * @retval undef_id   if a new leaf was inserted
-      **/
-    virtual node_t find_or_insert(const node_t& parent, uliteral_t c) = 0;
-
-	/**
-	 * Returns the number of entries, plus the number of rootnodes
-	 */
-    virtual factorid_t size() const = 0;
 
+protected:
+    inline LZ78Trie() {
+        // the derived class is complete once this constructor gets instantiated
+        static_assert(std::is_same<node_t,
+            decltype(std::declval<trie_t&>().add_rootnode(uliteral_t()))>::value,
+            "LZ78 trie requires node_t add_rootnode(uliteral_t)");
+        static_assert(std::is_same<node_t,
+            decltype(std::declval<trie_t&>().get_rootnode(uliteral_t()))>::value,
+            "LZ78 trie requires node_t get_rootnode(uliteral_t)");
+        static_assert(std::is_same<void,
+            decltype(std::declval<trie_t&>().clear())>::value,
+            "LZ78 trie requires void clear()");
+        static_assert(std::is_same<node_t,
+            decltype(std::declval<trie_t&>().find_or_insert(
+                std::declval<const node_t&>(), uliteral_t()))>::value,
+            "LZ78 trie requires node_t find_or_insert(const node_t&, uliteral_t)");
+        static_assert(std::is_same<factorid_t,
+            decltype(std::declval<const trie_t&>().size())>::value,
+            "LZ78 trie requires factorid_t size() const");
+    }
 };
 
 
@@ -96,6 +96,11 @@ class MyHash {
 		}
 	};
 
+	void clear() {
+		for(size_t i = 0; i < m_size; ++i) m_values[i] = undef_id;
+		m_entries = 0;
+	}
+
 	inline len_t entries() const { return m_entries; }
 	inline len_t table_size() const { return m_size; }
 
@@ -149,7 +154,7 @@ class MyHash {
 };
 
 
-class MyHashTrie : public Algorithm, public LZ78Trie<factorid_t> {
+class MyHashTrie : public Algorithm, public LZ78Trie<MyHashTrie> {
     using squeeze_node_t = ::tdc::lz78::node_t;
 	MyHash<squeeze_node_t,factorid_t,MixHasher,std::equal_to<squeeze_node_t>,LinearProber<squeeze_node_t>> table;
 
@@ -165,21 +170,20 @@ public:
 		}
     }
 
-	node_t add_rootnode(uliteral_t c) override {
+	node_t add_rootnode(uliteral_t c) {
 		table.insert(std::make_pair<squeeze_node_t,factorid_t>(create_node(0, c), size()));
 		return size() - 1;
 	}
 
-    node_t get_rootnode(uliteral_t c) override {
+    node_t get_rootnode(uliteral_t c) {
         return c;
     }
 
-	void clear() override {
-//		table.clear();
-
+	void clear() {
+		table.clear();
 	}
 
-    node_t find_or_insert(const node_t& parent_w, uliteral_t c) override {
+    node_t find_or_insert(const node_t& parent_w, uliteral_t c) {
         auto parent = parent_w.id();
         const factorid_t newleaf_id = size(); //! if we add a new node, its index will be equal to the current size of the dictionary
 
@@ -188,7 +192,7 @@ public:
 		return ret.first.value();
     }
 
-    factorid_t size() const override {
+    factorid_t size() const {
         return table.entries();
     }
 };
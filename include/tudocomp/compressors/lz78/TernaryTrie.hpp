@@ -12,7 +12,7 @@ namespace lz78 {
 ///
 /// \sa http://www.cplusplus.com/articles/iL18T05o/
 ///
-class TernaryTrie : public Algorithm, public LZ78Trie<factorid_t> {
+class TernaryTrie : public Algorithm, public LZ78Trie<TernaryTrie> {
 
 	/*
 	 * The trie is not stored in standard form. Each node stores the pointer to its first child (first as first come first served).
@@ -37,7 +37,7 @@ public:
 		}
     }
 
-	node_t add_rootnode(uliteral_t c) override {
+	node_t add_rootnode(uliteral_t c) {
         first_child.push_back(undef_id);
 		left_sibling.push_back(undef_id);
 		right_sibling.push_back(undef_id);
@@ -45,11 +45,11 @@ public:
 		return size() - 1;
 	}
 
-    node_t get_rootnode(uliteral_t c) override {
+    node_t get_rootnode(uliteral_t c) {
         return c;
     }
 
-	void clear() override {
+	void clear() {
         first_child.clear();
 		left_sibling.clear();
 		right_sibling.clear();
@@ -57,7 +57,7 @@ public:
 
 	}
 
-    node_t find_or_insert(const node_t& parent_w, uliteral_t c) override {
+    node_t find_or_insert(const node_t& parent_w, uliteral_t c) {
         auto parent = parent_w.id();
 
         const factorid_t newleaf_id = size(); //! if we add a new node, its index will be equal to the current size of the dictionary
@@ -98,7 +98,7 @@ public:
         return undef_id;
     }
 
-    factorid_t size() const override {
+    factorid_t size() const {
         return first_child.size();
     }
 };
@@ -15,6 +15,17 @@
 namespace tdc {
 namespace lzss {
 
+/// The longest run of literals between the factors of a text of length `n`.
+inline size_t longest_literal_run(size_t n, const FactorBuffer& factors) {
+    size_t longest = 0;
+    size_t p = 0;
+    for(size_t i = 0; i < factors.size(); i++) {
+        longest = std::max(longest, factors[i].pos - p);
+        p = factors[i].pos + factors[i].len;
+    }
+    return std::max(longest, n - p);
+}
+
 template<typename coder_t, typename text_t>
 inline void encode_text(coder_t& coder,
                         const text_t& text,
@@ -28,16 +39,7 @@ inline void encode_text(coder_t& coder,
     auto flen_max = factors.longest_factor();
 
     // determine longest distance between two factors
-    size_t fdist_max = 0;
-    {
-        size_t p = 0;
-        for(size_t i = 0; i < factors.size(); i++) {
-            fdist_max = std::max(fdist_max, factors[i].pos - p);
-            p = factors[i].pos + factors[i].len;
-        }
-
-        fdist_max = std::max(fdist_max, n - p);
-    }
+    size_t fdist_max = longest_literal_run(n, factors);
 
     // define ranges
     Range text_r(n);
@@ -1,12 +1,32 @@
 #pragma once
 
+#include <algorithm>
+#include <cstring>
 #include <ostream>
 #include <vector>
+#include <glog/logging.h>
 #include <tudocomp/def.hpp>
 
 namespace tdc {
 namespace lzss {
 
+/// Copies `num` characters from `buf[src..]` to `buf[dst..]`, with `src < dst`.
+/// If the regions overlap, the factor repeats its first `dst - src`
+/// characters, which is done by copying the repeated part with doubling
+/// lengths.
+inline void copy_factor(uliteral_t* buf, size_t src, size_t dst, size_t num) {
+    DCHECK_LT(src, dst);
+    const size_t dist = dst - src;
+    if(dist >= num) {
+        std::memcpy(buf + dst, buf + src, num);
+    } else {
+        std::memcpy(buf + dst, buf + src, dist);
+        for(size_t copied = dist; copied < num; copied *= 2) {
+            std::memcpy(buf + dst + copied, buf + dst, std::min(copied, num - copied));
+        }
+    }
+}
+
 class DecodeBackBuffer{
 
 private:
@@ -26,7 +46,9 @@ public:
     }
 
     inline void decode_factor(len_t pos, len_t num) {
-        while(num--) m_buffer[m_cursor++] = m_buffer[pos++];
+        DCHECK_LE(m_cursor + num, m_buffer.size());
+        copy_factor(m_buffer.data(), pos, m_cursor, num);
+        m_cursor += num;
     }
 
     inline len_t longest_chain() const {
@@ -34,7 +56,7 @@ public:
     }
 
     inline void write_to(std::ostream& out) {
-        for(auto c : m_buffer) out << c;
+        out.write(reinterpret_cast<const char*>(m_buffer.data()), m_buffer.size());
     }
 };
 
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <algorithm>
+#include <cstring>
+#include <ostream>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+#include <glog/logging.h>
+#include <tudocomp/def.hpp>
+#include <tudocomp/compressors/lzss/LZSSDecodeBackBuffer.hpp>
+
+namespace tdc {
+namespace lzss {
+
+/// Decodes a text whose factors refer at most `window` characters back.
+/// Only the last `window` characters are kept; the text before them is
+/// written to the output block by block, so the memory is independent of
+/// the text length.
+class DecodeWindowBuffer {
+    static constexpr size_t block_size = 1ULL << 20;
+
+    std::ostream* m_out;
+    size_t m_window;
+    std::vector<uliteral_t> m_buffer;
+    size_t m_cursor; //! end of the decoded text in the buffer
+    size_t m_written; //! m_buffer[..m_written] was written to the output
+    size_t m_offset; //! text position of m_buffer[0]
+
+    /// Makes room for `num` more characters.
+    inline void reserve(size_t num) {
+        if(tdc_likely(m_cursor + num <= m_buffer.size())) return;
+
+        flush();
+        const size_t keep = std::min(m_window, m_cursor);
+        const size_t drop = m_cursor - keep;
+        std::memmove(m_buffer.data(), m_buffer.data() + drop, keep);
+        m_cursor = keep;
+        m_written = keep;
+        m_offset += drop;
+
+        if(m_cursor + num > m_buffer.size()) m_buffer.resize(m_cursor + num);
+    }
+
+public:
+    inline DecodeWindowBuffer(size_t window, std::ostream& out)
+        : m_out(&out)
+        , m_window(window)
+        , m_buffer(window + std::max(window, size_t(block_size)))
+        , m_cursor(0)
+        , m_written(0)
+        , m_offset(0) {}
+
+    /// The number of decoded characters.
+    inline size_t size() const {
+        return m_offset + m_cursor;
+    }
+
+    inline void decode_literal(uliteral_t c) {
+        reserve(1);
+        m_buffer[m_cursor++] = c;
+    }
+
+    /// Decodes a factor starting `dist` characters before the current end.
+    inline void decode_factor(size_t dist, size_t num) {
+        if(dist == 0 || dist > std::min(m_window, size())) {
+            std::stringstream s;
+            s << "invalid factor distance " << dist << " at position " << size();
+            throw std::runtime_error(s.str());
+        }
+
+        reserve(num);
+        copy_factor(m_buffer.data(), m_cursor - dist, m_cursor, num);
+        m_cursor += num;
+    }
+
+    /// Writes the text decoded so far to the output.
+    inline void flush() {
+        m_out->write(reinterpret_cast<const char*>(m_buffer.data() + m_written),
+                     m_cursor - m_written);
+        m_written = m_cursor;
+    }
+};
+
+}} //ns
+
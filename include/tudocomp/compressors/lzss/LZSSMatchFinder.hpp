@@ -0,0 +1,274 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <tudocomp/def.hpp>
+#include <tudocomp/util.hpp>
+
+namespace tdc {
+namespace lzss {
+
+#define LZSS_FINDER_DESC \
+			"`finder` selects how matches in the window are found:\n" \
+			"`naive` compares each window position with the lookahead,\n" \
+			"`hashchain` follows a chain of positions with the same hash\n" \
+			"of the next characters, and\n" \
+			"`bt` searches a binary tree of the window's suffixes.\n" \
+			"`depth` limits the number of positions visited by\n" \
+			"`hashchain` and `bt`."
+
+/// A match of the current position with a source `dist` characters before.
+struct Match {
+    size_t len = 0;
+    size_t dist = 0;
+};
+
+/// Compares the strings at `a` and `b` from offset `len` on, up to `max_len`.
+inline size_t match_length(const uliteral_t* a, const uliteral_t* b, size_t len, size_t max_len) {
+    while(len < max_len && a[len] == b[len]) ++len;
+    return len;
+}
+
+/*
+ * The match finders index a buffer that slides over the text.
+ * Each position of the text is passed to the finder exactly once, in text
+ * order, either to `find` its longest match in the preceding `window`
+ * characters or to `skip` it because it lies within a factor. Both insert the
+ * position into the index. The positions are indices into the buffer; if the
+ * buffer drops its first characters, `slide` rebases the stored positions.
+ */
+
+/// Compares each position of the window with the current position.
+/// Of the longest matches, the one farthest away is reported.
+class NaiveFinder {
+    size_t m_window;
+
+public:
+    inline NaiveFinder(size_t window, size_t, size_t) : m_window(window) {}
+
+    inline Match find(const uliteral_t* buf, size_t i, size_t max_len) {
+        Match m;
+        for(size_t k = (i > m_window ? i - m_window : 0); k < i && m.len < max_len; ++k) {
+            const size_t len = match_length(buf + k, buf + i, 0, max_len);
+            if(len > m.len) {
+                m.len = len;
+                m.dist = i - k;
+            }
+        }
+        return m;
+    }
+
+    inline void skip(const uliteral_t*, size_t, size_t) {}
+    inline void slide(size_t) {}
+};
+
+/// Common parts of the indexed finders: the hash of the next `hash_len`
+/// characters and a cyclic array with an entry per window position.
+class IndexedFinder {
+protected:
+    static constexpr uint32_t none = UINT32_MAX;
+
+    size_t m_window;
+    size_t m_depth;
+    size_t m_hash_len;
+    size_t m_hash_bits;
+    size_t m_cyclic_mask;
+    size_t m_cyclic_pos; //! cyclic index of the current position
+    std::vector<uint32_t> m_head; //! hash -> last position with this hash
+
+    inline IndexedFinder(size_t window, size_t depth, size_t min_len)
+        : m_window(window)
+        , m_depth(std::max(depth, size_t(1)))
+        , m_hash_len(std::min(std::max(min_len, size_t(1)), size_t(4)))
+        , m_cyclic_pos(0)
+    {
+        // the cyclic array must not overwrite a position within the window
+        size_t cyclic_size = 1;
+        while(cyclic_size <= window) cyclic_size *= 2;
+        m_cyclic_mask = cyclic_size - 1;
+
+        m_hash_bits = std::min(std::max(size_t(bits_for(window)), size_t(12)), size_t(20));
+        m_head.assign(size_t(1) << m_hash_bits, uint32_t(none));
+    }
+
+    inline size_t hash(const uliteral_t* p) const {
+        uint32_t x = 0;
+        for(size_t k = 0; k < m_hash_len; ++k) x = (x << 8) | p[k];
+        return uint32_t(x * 2654435761u) >> (32 - m_hash_bits);
+    }
+
+    /// The cyclic index of the position `delta` characters before.
+    inline size_t cyclic(size_t delta) const {
+        return (m_cyclic_pos - delta) & m_cyclic_mask;
+    }
+
+    inline void advance() {
+        m_cyclic_pos = (m_cyclic_pos + 1) & m_cyclic_mask;
+    }
+
+    inline static void rebase(std::vector<uint32_t>& v, size_t d) {
+        for(auto& p : v) p = (p == none || p < d) ? none : p - d;
+    }
+};
+
+/// Follows the chain of preceding positions with the same hash,
+/// visiting at most `depth` positions.
+class HashChainFinder : public IndexedFinder {
+    std::vector<uint32_t> m_prev; //! cyclic position -> previous position with the same hash
+
+    inline void insert(size_t i, size_t h) {
+        m_prev[m_cyclic_pos] = m_head[h];
+        m_head[h] = i;
+        advance();
+    }
+
+public:
+    inline HashChainFinder(size_t window, size_t depth, size_t min_len)
+        : IndexedFinder(window, depth, min_len)
+        , m_prev(m_cyclic_mask + 1, uint32_t(none)) {}
+
+    inline Match find(const uliteral_t* buf, size_t i, size_t max_len) {
+        Match m;
+        if(max_len < m_hash_len) {
+            advance();
+            return m;
+        }
+
+        const size_t h = hash(buf + i);
+        uint32_t k = m_head[h];
+        for(size_t depth = m_depth; depth > 0 && k != none; --depth) {
+            const size_t delta = i - k;
+            if(delta > m_window) break;
+
+            // a longer match has to extend the best match so far
+            if(buf[k + m.len] == buf[i + m.len]) {
+                const size_t len = match_length(buf + k, buf + i, 0, max_len);
+                if(len > m.len) {
+                    m.len = len;
+                    m.dist = delta;
+                    if(len == max_len) break;
+                }
+            }
+            k = m_prev[cyclic(delta)];
+        }
+
+        insert(i, h);
+        return m;
+    }
+
+    inline void skip(const uliteral_t* buf, size_t i, size_t max_len) {
+        if(max_len < m_hash_len) {
+            advance();
+        } else {
+            insert(i, hash(buf + i));
+        }
+    }
+
+    inline void slide(size_t d) {
+        rebase(m_head, d);
+        rebase(m_prev, d);
+    }
+};
+
+/// Keeps a binary search tree of the suffixes starting in the window for
+/// each hash value (as the bt match finder of LZMA). Inserting the current
+/// position as the new root splits the tree along the search path, such that
+/// each step of the search either finds a longer match or discards a subtree.
+/// At most `depth` nodes are visited.
+///
+/// Suffixes are only compared up to `nice_len` characters, otherwise each
+/// position within a long factor would be compared along the whole factor
+/// when it is inserted. A match of this length is extended afterwards.
+class BinaryTreeFinder : public IndexedFinder {
+    static constexpr size_t nice_len = 256;
+
+    std::vector<uint32_t> m_son; //! 2 * cyclic position -> left and right child
+
+    /// Inserts position `i` and reports its longest match if `m` is given.
+    inline void insert(const uliteral_t* buf, size_t i, size_t max_len, Match* m) {
+        const size_t h = hash(buf + i);
+        uint32_t k = m_head[h];
+        m_head[h] = i;
+
+        // the subtrees of smaller and larger suffixes under construction
+        uint32_t* smaller = &m_son[2 * m_cyclic_pos];
+        uint32_t* larger = &m_son[2 * m_cyclic_pos + 1];
+        size_t len_smaller = 0, len_larger = 0;
+
+        for(size_t depth = m_depth; ; --depth) {
+            const size_t delta = i - k;
+            if(k == none || delta > m_window || depth == 0) {
+                *smaller = *larger = none;
+                break;
+            }
+
+            uint32_t* pair = &m_son[2 * cyclic(delta)];
+            // both neighbours share a prefix of this length with buf[i..]
+            const size_t len = match_length(buf + k, buf + i,
+                std::min(len_smaller, len_larger), max_len);
+
+            if(m && len > m->len) {
+                m->len = len;
+                m->dist = delta;
+            }
+
+            if(len == max_len) {
+                // the suffix at k is replaced by the one at i
+                *smaller = pair[0];
+                *larger = pair[1];
+                break;
+            }
+
+            if(buf[k + len] < buf[i + len]) {
+                *smaller = k;
+                smaller = pair + 1;
+                k = *smaller;
+                len_smaller = len;
+            } else {
+                *larger = k;
+                larger = pair;
+                k = *larger;
+                len_larger = len;
+            }
+        }
+        advance();
+    }
+
+public:
+    inline BinaryTreeFinder(size_t window, size_t depth, size_t min_len)
+        : IndexedFinder(window, depth, min_len)
+        , m_son(2 * (m_cyclic_mask + 1), uint32_t(none)) {}
+
+    inline Match find(const uliteral_t* buf, size_t i, size_t max_len) {
+        Match m;
+        if(max_len < m_hash_len) {
+            advance();
+            return m;
+        }
+
+        const size_t limit = std::min(max_len, size_t(nice_len));
+        insert(buf, i, limit, &m);
+        if(m.len == limit) {
+            m.len = match_length(buf + i - m.dist, buf + i, m.len, max_len);
+        }
+        return m;
+    }
+
+    inline void skip(const uliteral_t* buf, size_t i, size_t max_len) {
+        if(max_len < m_hash_len) {
+            advance();
+        } else {
+            insert(buf, i, std::min(max_len, size_t(nice_len)), nullptr);
+        }
+    }
+
+    inline void slide(size_t d) {
+        rebase(m_head, d);
+        rebase(m_son, d);
+    }
+};
+
+}} //ns
+
@@ -0,0 +1,224 @@
+#pragma once
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+#include <tudocomp/Env.hpp>
+#include <tudocomp/Range.hpp>
+#include <tudocomp/io.hpp>
+#include <tudocomp/util.hpp>
+
+#include <tudocomp/compressors/lzss/LZSSFactors.hpp>
+#include <tudocomp/compressors/lzss/LZSSLiterals.hpp>
+#include <tudocomp/compressors/lzss/LZSSSmallerValues.hpp>
+
+namespace tdc {
+namespace lzss {
+
+/**
+ * Estimates the bits that a coder spends on the values written by
+ * \ref encode_text, by encoding sample values with the coder into a
+ * scratch buffer.
+ *
+ * Each value is encoded `probes` times and the costs are the sums of these
+ * encodings, such that coders buffering their output (e.g., arithmetic coding)
+ * get a meaningful average. Integers are assumed to cost the same if they
+ * have the same bit width.
+ */
+class CostModel {
+public:
+    using cost_t = uint64_t;
+
+private:
+    static constexpr size_t probes = 64;
+    static constexpr size_t widths = 65; //! indexed by bits_for(v)
+
+    cost_t m_bit[2];
+    std::vector<cost_t> m_literal;
+    std::vector<cost_t> m_src; //! factor source, by bit width
+    std::vector<cost_t> m_len; //! factor length, by bit width
+    std::vector<cost_t> m_run; //! number of literals, by bit width
+
+    template<typename coder_t, typename range_t>
+    inline static std::vector<cost_t> measure_ints(coder_t& coder, const range_t& r) {
+        std::vector<cost_t> costs(widths, 0);
+        const auto& out = *coder.stream();
+        for(size_t w = 1; w < widths; ++w) {
+            // the smallest value of this width, within the range
+            const size_t v = std::max(std::min(w == 1 ? size_t(0) : size_t(1) << (w - 1), r.max()), r.min());
+            const size_t before = out.bits_written();
+            for(size_t k = 0; k < probes; ++k) coder.encode(v, r);
+            costs[w] = out.bits_written() - before;
+        }
+        return costs;
+    }
+
+    inline CostModel() : m_literal(ULITERAL_MAX + 1, 0) {}
+
+public:
+    /// Measures the costs for the text encoded with `coder_t`.
+    ///
+    /// \param factors the factors of a previous parse, if any, which
+    ///        determine the literals the coder is initialized with
+    /// \param len_min, len_max the range of factor lengths
+    /// \param run_max the maximum number of consecutive literals
+    template<typename coder_t, typename text_t>
+    inline static CostModel measure(Env&& env, const text_t& text, const FactorBuffer& factors,
+                                    size_t len_min, size_t len_max, size_t run_max) {
+        CostModel m;
+        const size_t n = text.size();
+
+        std::vector<bool> occurs(ULITERAL_MAX + 1, false);
+        for(size_t i = 0; i < n; ++i) occurs[uliteral_t(text[i])] = true;
+
+        std::vector<uint8_t> scratch;
+        Output out = Output::from_memory(scratch);
+        coder_t coder(std::move(env), out, TextLiterals<text_t>(text, factors));
+        const auto& bits = *coder.stream();
+
+        for(size_t b = 0; b < 2; ++b) {
+            const size_t before = bits.bits_written();
+            for(size_t k = 0; k < probes; ++k) coder.encode(bool(b), bit_r);
+            m.m_bit[b] = bits.bits_written() - before;
+        }
+
+        // the coder might not be able to encode literals it was not
+        // initialized with
+        for(size_t c = 0; c <= ULITERAL_MAX; ++c) {
+            if(!occurs[c]) continue;
+            const size_t before = bits.bits_written();
+            for(size_t k = 0; k < probes; ++k) coder.encode(uliteral_t(c), literal_r);
+            m.m_literal[c] = bits.bits_written() - before;
+        }
+
+        m.m_src = measure_ints(coder, Range(n));
+        m.m_len = measure_ints(coder, MinDistributedRange(len_min, std::max(len_min, len_max)));
+        m.m_run = measure_ints(coder, Range(run_max));
+        return m;
+    }
+
+    inline cost_t bit(bool b) const { return m_bit[b]; }
+    inline cost_t literal(uliteral_t c) const { return m_literal[c]; }
+    inline cost_t src(size_t v) const { return m_src[bits_for(v)]; }
+    inline cost_t len(size_t v) const { return m_len[bits_for(v)]; }
+    inline cost_t run(size_t v) const { return m_run[bits_for(v)]; }
+};
+
+/**
+ * Computes an LZSS factorization of minimum cost with respect to a
+ * \ref CostModel, as a shortest path over the positions of the text.
+ *
+ * The candidate sources of position i are the closest suffixes with a
+ * smaller text position in the suffix array, before and after the suffix i
+ * (PSV and NSV). Their longest common prefix with suffix i is the longest
+ * previous factor. For each source, all lengths from `threshold` up to
+ * `max_len_tried` are tried, and the full length if it is longer.
+ *
+ * The cost of a run of literals depends on whether it starts after a factor,
+ * so the path is computed for two states: after a factor and after a literal.
+ */
+template<typename text_t>
+class OptimalParser {
+    using cost_t = CostModel::cost_t;
+    static constexpr size_t max_len_tried = 64;
+
+    const text_t* m_text;
+    len_t m_threshold;
+
+    // the candidate sources and their lengths per text position
+    std::vector<len_t> m_src[2];
+    std::vector<len_t> m_len[2];
+
+public:
+    template<typename sa_t, typename lcp_t>
+    inline OptimalParser(const text_t& text, const sa_t& sa, const lcp_t& lcp, len_t threshold)
+        : m_text(&text), m_threshold(std::max(threshold, len_t(1)))
+    {
+        const size_t n = text.size();
+        SmallerValuesStack stack;
+        for(size_t dir = 0; dir < 2; ++dir) {
+            m_src[dir].resize(n);
+            m_len[dir].resize(n);
+            smaller_values(sa, lcp, n, dir == 1, stack, [&](len_t i, len_t src, len_t len) {
+                m_src[dir][i] = src;
+                m_len[dir][i] = len;
+            });
+        }
+    }
+
+    /// Computes the factorization of minimum cost.
+    inline FactorBuffer parse(const CostModel& cost) const {
+        const text_t& text = *m_text;
+        const size_t n = text.size();
+
+        // cost of the suffix i.. after a factor (0) or a literal (1)
+        std::vector<cost_t> total[2];
+        total[0].resize(n + 1, 0);
+        total[1].resize(n + 1, 0);
+
+        std::vector<len_t> factor_len(n, 0); //! best factor at i, 0 if none
+        std::vector<bool> factor_src(n, false); //! source of the best factor
+        std::vector<bool> take_factor[2];
+        take_factor[0].resize(n, false);
+        take_factor[1].resize(n, false);
+
+        // a run of literals costs a 1-bit and its length
+        const cost_t run_cost = cost.bit(true) + cost.run(1);
+
+        for(size_t i = n; i-- > 0;) {
+            const cost_t lit = cost.literal(text[i]) + total[1][i + 1];
+
+            // the last character (\0) is always a literal
+            cost_t best = std::numeric_limits<cost_t>::max();
+            const len_t len[2] = {
+                i + 1 < n ? m_len[0][i] : len_t(0),
+                i + 1 < n ? m_len[1][i] : len_t(0) };
+            const len_t max_len = std::max(len[0], len[1]);
+
+            if(max_len >= m_threshold) {
+                const cost_t src_cost[2] = { cost.src(m_src[0][i]), cost.src(m_src[1][i]) };
+
+                auto consider = [&](len_t l) {
+                    // the cheaper source among the ones that are long enough
+                    const bool d = (l > len[0]) || (l <= len[1] && src_cost[1] < src_cost[0]);
+                    const cost_t c = src_cost[d] + cost.len(l) + total[0][i + l];
+                    if(c < best) {
+                        best = c;
+                        factor_len[i] = l;
+                        factor_src[i] = d;
+                    }
+                };
+
+                const len_t tried = std::min(max_len, len_t(max_len_tried));
+                for(len_t l = m_threshold; l <= tried; ++l) consider(l);
+                if(max_len > tried) consider(max_len);
+            }
+
+            if(factor_len[i] > 0) {
+                take_factor[0][i] = cost.bit(false) + best < run_cost + lit;
+                take_factor[1][i] = best < lit;
+            }
+            total[0][i] = take_factor[0][i] ? cost.bit(false) + best : run_cost + lit;
+            total[1][i] = take_factor[1][i] ? best : lit;
+        }
+
+        FactorBuffer factors;
+        size_t state = 0;
+        for(size_t i = 0; i < n;) {
+            if(take_factor[state][i]) {
+                const len_t l = factor_len[i];
+                factors.emplace_back(i, m_src[factor_src[i]][i], l);
+                i += l;
+                state = 0;
+            } else {
+                ++i;
+                state = 1;
+            }
+        }
+        return factors;
+    }
+};
+
+}} //ns
+
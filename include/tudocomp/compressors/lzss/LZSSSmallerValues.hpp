@@ -0,0 +1,60 @@
+#pragma once
+
+#include <algorithm>
+#include <limits>
+#include <utility>
+#include <vector>
+#include <tudocomp/def.hpp>
+
+namespace tdc {
+namespace lzss {
+
+/// A stack entry of \ref smaller_values: the text position of a suffix
+/// array entry and the minimum LCP value between this entry and the one above.
+using SmallerValuesStack = std::vector<std::pair<len_t, len_t>>;
+
+/**
+ * Computes for each suffix the closest suffix array entry with a smaller text
+ * position, scanning the suffix array forwards (PSV) or backwards (NSV), with
+ * a stack of entries with increasing text positions. The LCP of a suffix with
+ * this entry is the length of the longest previous factor in that direction.
+ *
+ * For each text position i, `report(i, src, len)` is called with the text
+ * position `src` of the entry and the length `len` of the common prefix, or
+ * with `len = 0` if there is no such entry.
+ *
+ * The stack holds at most `n` entries. It is passed by the caller, such that
+ * its capacity can be reserved beforehand.
+ *
+ * \param lcp lcp[j] is the LCP of the suffix array entries j-1 and j
+ */
+template<typename sa_t, typename lcp_t, typename report_t>
+inline void smaller_values(const sa_t& sa, const lcp_t& lcp, size_t n, bool backwards,
+                           SmallerValuesStack& stack, report_t report) {
+    stack.clear();
+    for(size_t k = 0; k < n; ++k) {
+        const size_t j = backwards ? n - 1 - k : k;
+        const len_t i = sa[j];
+        if(!stack.empty()) {
+            const len_t h = backwards ? lcp[j + 1] : lcp[j];
+            stack.back().second = std::min(stack.back().second, h);
+
+            while(!stack.empty() && stack.back().first > i) {
+                const len_t popped = stack.back().second;
+                stack.pop_back();
+                if(!stack.empty()) {
+                    stack.back().second = std::min(stack.back().second, popped);
+                }
+            }
+        }
+
+        if(stack.empty()) {
+            report(i, len_t(0), len_t(0));
+        } else {
+            report(i, stack.back().first, stack.back().second);
+        }
+        stack.emplace_back(i, std::numeric_limits<len_t>::max());
+    }
+}
+
+}} //ns
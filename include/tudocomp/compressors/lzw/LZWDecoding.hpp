@@ -2,6 +2,8 @@
 
 #include <tudocomp/util.hpp>
 #include <tudocomp/compressors/lz78/LZ78Trie.hpp>
+#include <tudocomp/compressors/lz78/Dictionary.hpp>
+#include <tudocomp/compressors/lz78/DecodeBuffer.hpp>
 #include <tudocomp/compressors/lzw/LZWFactor.hpp>
 
 namespace tdc {
@@ -9,94 +11,80 @@ namespace lzw {
 
 using CodeType = lz78::factorid_t;
 
-template<class F>
-void decode_step(F next_code_callback,
-                 std::ostream& out,
-                 const CodeType dms,
-                 const CodeType reserve_dms) {
-    std::vector<std::pair<CodeType, uliteral_t>> dictionary;
-
-    // "named" lambda function, used to reset the dictionary to its initial contents
-    const auto reset_dictionary = [&] {
-        dictionary.clear();
-        dictionary.reserve(reserve_dms);
-
-        const long int minc = std::numeric_limits<uliteral_t>::min();
-        const long int maxc = std::numeric_limits<uliteral_t>::max();
-
-        for (long int c = minc; c <= maxc; ++c)
-            dictionary.push_back({dms, static_cast<uliteral_t> (c)});
-    };
-
-    const auto rebuild_string = [&](CodeType k) -> const std::vector<uliteral_t> * {
-        static std::vector<uliteral_t> s; // String
-
-        s.clear();
-
-        // the length of a string cannot exceed the dictionary's number of entries
-        s.reserve(reserve_dms);
-
-        while (k != dms)
-        {
-            s.push_back(dictionary[k].second);
-            k = dictionary[k].first;
-        }
-
-        std::reverse(s.begin(), s.end());
-        return &s;
-    };
-
-    reset_dictionary();
-
-    CodeType i {dms}; // Index
-    CodeType k; // Key
-
-    bool corrupted = false;
-
-    while (true)
-    {
-        bool dictionary_reset = false;
-
-        // dictionary's maximum size was reached
-        if (dictionary.size() == dms)
-        {
-            reset_dictionary();
-            dictionary_reset = true;
-        }
-
-        if (!next_code_callback(k, dictionary_reset, corrupted))
-            break;
-
-        //std::cout << byte_to_nice_ascii_char(k) << "\n";
+/**
+ * Restores the text from LZW codes with the same dictionary policy as the
+ * compressor. A factor is copied from the decoded text.
+ *
+ * The compressor adds the entry of a factor once it has read the first
+ * character of the next factor. The decompressor adds the entry as soon as it
+ * reads the code of the factor, such that both dictionaries have the same size
+ * when the next code is transmitted. The string of this pending entry is the
+ * factor followed by the first character of the next factor.
+ */
+class Decompressor {
+    lz78::Dictionary m_dict;
+    lz78::DecodeBuffer m_buffer;
+    CodeType m_pending; //! entry whose last character is not yet known
+    uint64_t m_factor_count;
+
+public:
+    inline Decompressor(lz78::DictPolicy policy, lz78::factorid_t max_size, size_t reserve = 0)
+        : m_dict(policy, max_size, ULITERAL_MAX + 1, true, reserve)
+        , m_buffer(ULITERAL_MAX + 1)
+        , m_pending(lz78::undef_id)
+        , m_factor_count(0) {}
+
+    /// The number of dictionary entries, including the root nodes.
+    inline lz78::factorid_t size() const {
+        return m_dict.size();
+    }
 
-        if (k > dictionary.size()) {
+    inline void decompress(CodeType k, std::ostream& out) {
+        if (k >= m_dict.size()) {
             std::stringstream s;
             s << "invalid compressed code " << k;
             throw std::runtime_error(s.str());
         }
 
-        const std::vector<uliteral_t> *s; // String
-
-        if (k == dictionary.size())
-        {
-            dictionary.push_back({i, rebuild_string(i)->front()});
-            s = rebuild_string(k);
+        // the first character of the pending entry is known
+        // even if k is the pending entry
+        if(m_pending != lz78::undef_id) {
+            m_buffer.set_last_literal(m_pending, m_buffer.first_literal(k));
         }
-        else
-        {
-            s = rebuild_string(k);
 
-            if (i != dms)
-                dictionary.push_back({i, s->front()});
+        const size_t offset = m_buffer.size();
+        m_buffer.append(k);
+
+        const bool frozen = m_dict.frozen();
+        const CodeType id = m_dict.size();
+        m_dict.touch(k, m_factor_count);
+        const auto event = m_dict.add(k, 0, m_factor_count++);
+        // the entry ends with the first character of the next factor
+        if(!frozen) m_buffer.set_entry(id, offset, m_buffer.length(k) + 1);
+
+        switch(event) {
+            case lz78::Dictionary::Event::none:
+                m_pending = frozen ? lz78::undef_id : id;
+                if(!frozen && m_dict.frozen()) {
+                    m_buffer.compact(out, id + 1, [](CodeType i) { return i; }, true);
+                }
+                break;
+            case lz78::Dictionary::Event::reset:
+                m_pending = lz78::undef_id;
+                m_buffer.reset(out);
+                break;
+            case lz78::Dictionary::Event::pruned:
+                m_pending = m_dict.renumbered(id);
+                m_buffer.compact(out, id + 1, [&](CodeType i) { return m_dict.renumbered(i); }, false);
+                break;
         }
-
-        out.write((char*) &s->front(), s->size());
-        i = k;
+        m_buffer.flush_if_full(out);
     }
 
-    if (corrupted)
-        throw std::runtime_error("corrupted compressed file");
-}
+    inline void flush(std::ostream& out) {
+        m_buffer.flush(out);
+    }
+};
 
 }} //ns
 
@@ -0,0 +1,178 @@
+#pragma once
+
+#include <algorithm>
+#include <cstring>
+#include <ostream>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+#include <tudocomp/compressors/repair/Grammar.hpp>
+
+namespace tdc {
+namespace repair {
+
+/**
+ * Expands the symbols of a RePair grammar into their text, without
+ * recursion.
+ *
+ * The expansion lengths of all rules are computed beforehand. RePair creates
+ * the rules in the order of decreasing frequency, so the expansions of the
+ * first rules, up to `cache_size` characters in total, are kept in a cache
+ * and copied as a whole. A rule longer than `max_cached` characters is not
+ * cached. Other rules are expanded with an explicit stack, down to cached
+ * rules or terminals.
+ *
+ * The text is collected in a buffer that is written to the output in blocks.
+ */
+class Expander {
+    static constexpr size_t buffer_size = 1ULL << 16;
+    static constexpr len_t not_cached = LEN_MAX;
+
+    const grammar_t* m_grammar;
+    std::vector<len_t> m_length; //! expansion length per rule
+    std::vector<len_t> m_cache_pos; //! position of the expansion in the cache
+    std::vector<uliteral_t> m_cache;
+
+    std::vector<sym_t> m_stack;
+
+    struct Part {
+        sym_t x;
+        len_t from, to; //! the part [from, to) of the expansion of x
+    };
+    std::vector<Part> m_parts;
+    std::vector<uliteral_t> m_buffer;
+
+    /// Appends the expansion of x to `out`. If `os` is given, `out` is
+    /// written to it whenever it is full.
+    inline void expand_into(sym_t x, std::vector<uliteral_t>& out, std::ostream* os) {
+        m_stack.push_back(x);
+        while(!m_stack.empty()) {
+            const sym_t y = m_stack.back();
+            m_stack.pop_back();
+
+            if(y < sigma) {
+                out.push_back(uliteral_t(y));
+            } else if(m_cache_pos[y - sigma] != not_cached) {
+                // out may be the cache itself, which is copied from after
+                // it has grown
+                const size_t len = m_length[y - sigma];
+                const size_t old_size = out.size();
+                out.resize(old_size + len);
+                std::memcpy(out.data() + old_size, m_cache.data() + m_cache_pos[y - sigma], len);
+            } else {
+                const digram_t di = (*m_grammar)[y - sigma];
+                m_stack.push_back(right(di));
+                m_stack.push_back(left(di));
+                continue;
+            }
+            if(os && out.size() >= buffer_size) flush(*os);
+        }
+    }
+
+    inline size_t expansion_length(sym_t x) const {
+        return x < sigma ? 1 : m_length[x - sigma];
+    }
+
+    inline void check_symbol(sym_t x) const {
+        if(x >= sigma + m_grammar->size()) {
+            std::stringstream s;
+            s << "invalid symbol " << x;
+            throw std::runtime_error(s.str());
+        }
+    }
+
+public:
+    /// \param grammar the rules, each referring only to previous rules
+    /// \param cache_size the total length of the cached expansions
+    /// \param max_cached the maximum length of a cached expansion
+    inline Expander(const grammar_t& grammar,
+                    size_t cache_size = 1ULL << 22,
+                    size_t max_cached = 1ULL << 12)
+        : m_grammar(&grammar)
+        , m_length(grammar.size())
+        , m_cache_pos(grammar.size(), len_t(not_cached))
+    {
+        for(size_t k = 0; k < grammar.size(); ++k) {
+            const sym_t l = left(grammar[k]);
+            const sym_t r = right(grammar[k]);
+            if(l >= sigma + k || r >= sigma + k) {
+                std::stringstream s;
+                s << "invalid grammar rule " << k;
+                throw std::runtime_error(s.str());
+            }
+
+            const size_t len = expansion_length(l) + expansion_length(r);
+            if(len > LEN_MAX) throw std::runtime_error("grammar expansion too long");
+            m_length[k] = len;
+        }
+
+        // choose the cached rules, then expand them into the cache (which
+        // is reserved, as cached expansions are copied from it)
+        size_t total = 0;
+        std::vector<len_t> cached;
+        for(size_t k = 0; k < grammar.size(); ++k) {
+            if(m_length[k] <= max_cached && total + m_length[k] <= cache_size) {
+                cached.push_back(k);
+                total += m_length[k];
+            }
+        }
+
+        m_cache.reserve(total);
+        for(len_t k : cached) {
+            const len_t pos = m_cache.size();
+            expand_into(sigma + k, m_cache, nullptr);
+            m_cache_pos[k] = pos;
+        }
+
+        m_buffer.reserve(buffer_size);
+    }
+
+    /// The expansion length of a symbol.
+    inline size_t length(sym_t x) const {
+        check_symbol(x);
+        return expansion_length(x);
+    }
+
+    /// Writes the expansion of x to the output.
+    inline void expand(sym_t x, std::ostream& out) {
+        check_symbol(x);
+        expand_into(x, m_buffer, &out);
+    }
+
+    /// Writes the part [from, to) of the expansion of x to the output.
+    ///
+    /// Only the rules on the paths to the first and the last character are
+    /// descended into partially, so this takes O(height + to - from) time.
+    inline void extract(sym_t x, size_t from, size_t to, std::ostream& out) {
+        check_symbol(x);
+        to = std::min(to, expansion_length(x));
+        if(from >= to) return;
+
+        m_parts.push_back(Part { x, len_t(from), len_t(to) });
+        while(!m_parts.empty()) {
+            const Part p = m_parts.back();
+            m_parts.pop_back();
+
+            if(p.from == 0 && p.to == expansion_length(p.x)) {
+                expand_into(p.x, m_buffer, &out);
+            } else {
+                const digram_t di = (*m_grammar)[p.x - sigma];
+                const len_t ll = expansion_length(left(di));
+                if(p.to > ll) {
+                    m_parts.push_back(Part { right(di), len_t(std::max(p.from, ll) - ll), len_t(p.to - ll) });
+                }
+                if(p.from < ll) {
+                    m_parts.push_back(Part { left(di), p.from, std::min(p.to, ll) });
+                }
+            }
+        }
+    }
+
+    /// Writes the buffered text to the output.
+    inline void flush(std::ostream& out) {
+        out.write(reinterpret_cast<const char*>(m_buffer.data()), m_buffer.size());
+        m_buffer.clear();
+    }
+};
+
+}} //ns
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <tudocomp/def.hpp>
+
+namespace tdc {
+namespace repair {
+
+/// A symbol of the grammar. Symbols below \ref sigma are terminals, the
+/// symbol `sigma + k` is the non-terminal of the k-th rule.
+typedef uint32_t sym_t;
+
+/// The right-hand side of a rule, a pair of symbols.
+typedef uint64_t digram_t;
+
+/// The rules of the grammar, in order of creation.
+typedef std::vector<digram_t> grammar_t;
+
+constexpr size_t digram_shift = 32UL;
+constexpr sym_t sigma = 256; //TODO
+
+inline digram_t digram(sym_t l, sym_t r) {
+    return (digram_t(l) << digram_shift) | digram_t(r);
+}
+
+inline sym_t left(digram_t di) {
+    return sym_t(di >> digram_shift);
+}
+
+inline sym_t right(digram_t di) {
+    return sym_t(di);
+}
+
+}} //ns
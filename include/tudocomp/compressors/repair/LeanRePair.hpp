@@ -0,0 +1,73 @@
+#pragma once
+
+#include <unordered_map>
+#include <tudocomp/util.hpp>
+#include <tudocomp/ds/IntVector.hpp>
+#include <tudocomp/compressors/repair/Grammar.hpp>
+
+namespace tdc {
+namespace repair {
+
+/// Computes the same RePair grammar as \ref naive_repair with less memory.
+///
+/// The text is kept in a bit-packed vector whose width grows with the
+/// number of rules. Instead of linking the positions that were not replaced,
+/// each replacement pass compacts the text in place, so the text never takes
+/// more than `bits_for(sigma + rules)` bits per remaining symbol.
+///
+/// \param text the input text, replaced by the start rule
+/// \return the number of replaced digram occurrences
+inline size_t lean_repair(DynamicIntVector& text, grammar_t& grammar, size_t max_rules) {
+    size_t num_replaced = 0;
+
+    while(grammar.size() < max_rules && text.size() > 1) {
+        const size_t n = text.size();
+
+        // count digrams
+        digram_t max;
+        size_t max_count = 0;
+
+        {
+            std::unordered_map<digram_t, size_t> count;
+
+            for(size_t i = 0; i + 1 < n; ++i) {
+                const digram_t di = digram(sym_t(text[i]), sym_t(text[i + 1]));
+                const size_t c = ++count[di];
+                if(c > max_count) {
+                    max = di;
+                    max_count = c;
+                }
+            }
+        }
+
+        if(max_count <= 1) break; // done
+
+        // replace most common digram (max)
+        const sym_t new_sym = sigma + grammar.size();
+        grammar.push_back(max);
+
+        if(bits_for(new_sym) > text.width()) {
+            text.width(bits_for(new_sym));
+        }
+
+        const sym_t l = left(max);
+        const sym_t r = right(max);
+
+        size_t w = 0;
+        for(size_t i = 0; i < n;) {
+            if(i + 1 < n && sym_t(text[i]) == l && sym_t(text[i + 1]) == r) {
+                text[w++] = new_sym;
+                i += 2;
+                ++num_replaced;
+            } else {
+                text[w++] = sym_t(text[i++]);
+            }
+        }
+        text.resize(w);
+    }
+
+    text.shrink_to_fit();
+    return num_replaced;
+}
+
+}} //ns
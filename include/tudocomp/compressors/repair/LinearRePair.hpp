@@ -0,0 +1,273 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <unordered_map>
+#include <vector>
+#include <glog/logging.h>
+#include <tudocomp/compressors/repair/Grammar.hpp>
+
+namespace tdc {
+namespace repair {
+
+/**
+ * Computes the RePair grammar in expected linear time, following Larsson and
+ * Moffat ("Offline Dictionary-Based Compression", 1999).
+ *
+ * The occurrences of each digram are kept in a doubly linked list. The digrams
+ * occurring at least twice are kept in a priority queue of buckets by
+ * frequency; digrams that occur at least sqrt(n) times share the last bucket.
+ * Replacing a digram only updates the counts of the digrams overlapping its
+ * occurrences.
+ *
+ * Overlapping occurrences of a digram `xx` (as in `xxx`) are counted once.
+ */
+class LinearRePair {
+    static constexpr len_t none = std::numeric_limits<len_t>::max();
+    static constexpr len_t unlinked = none - 1; //! occurrence not in a list
+
+    struct Pair {
+        digram_t di;
+        len_t freq;
+        len_t first, last; //! occurrence list
+        len_t prev, next; //! neighbours in the bucket
+    };
+
+    std::vector<sym_t>* m_text;
+
+    // text positions that were not replaced, as a doubly linked list
+    std::vector<len_t> m_next;
+    std::vector<len_t> m_prev;
+
+    // the occurrences of the digram at each text position
+    std::vector<len_t> m_occ_next;
+    std::vector<len_t> m_occ_prev;
+
+    std::vector<Pair> m_pairs;
+    std::vector<len_t> m_free_pairs;
+    std::unordered_map<digram_t, len_t> m_index;
+
+    std::vector<len_t> m_bucket; //! frequency -> first pair
+    size_t m_top; //! no bucket above is occupied
+
+    inline bool linked(len_t i) const {
+        return m_occ_prev[i] != unlinked;
+    }
+
+    inline digram_t digram_at(len_t i) const {
+        return digram((*m_text)[i], (*m_text)[m_next[i]]);
+    }
+
+    inline size_t bucket_of(len_t freq) const {
+        return std::min(size_t(freq), m_bucket.size() - 1);
+    }
+
+    inline void enqueue(len_t k) {
+        Pair& p = m_pairs[k];
+        if(p.freq < 2) return;
+
+        const size_t b = bucket_of(p.freq);
+        p.prev = none;
+        p.next = m_bucket[b];
+        if(p.next != none) m_pairs[p.next].prev = k;
+        m_bucket[b] = k;
+        m_top = std::max(m_top, b);
+    }
+
+    inline void dequeue(len_t k) {
+        Pair& p = m_pairs[k];
+        if(p.freq < 2) return;
+
+        if(p.prev != none) m_pairs[p.prev].next = p.next;
+        else m_bucket[bucket_of(p.freq)] = p.next;
+        if(p.next != none) m_pairs[p.next].prev = p.prev;
+    }
+
+    /// Adds the digram occurrence at text position i.
+    inline void add_occurrence(len_t i) {
+        const digram_t di = digram_at(i);
+
+        // skip an occurrence of xx overlapping another one
+        if(left(di) == right(di)) {
+            const len_t p = m_prev[i];
+            const len_t j = m_next[i];
+            if(p != none && linked(p) && (*m_text)[p] == left(di)) return;
+            if(m_next[j] != none && linked(j) && (*m_text)[m_next[j]] == left(di)) return;
+        }
+
+        len_t k;
+        auto it = m_index.find(di);
+        if(it != m_index.end()) {
+            k = it->second;
+            dequeue(k);
+        } else {
+            if(m_free_pairs.empty()) {
+                k = m_pairs.size();
+                m_pairs.emplace_back();
+            } else {
+                k = m_free_pairs.back();
+                m_free_pairs.pop_back();
+            }
+            m_pairs[k] = Pair { di, 0, none, none, none, none };
+            m_index.emplace(di, k);
+        }
+
+        Pair& p = m_pairs[k];
+        m_occ_prev[i] = p.last;
+        m_occ_next[i] = none;
+        if(p.last != none) m_occ_next[p.last] = i;
+        else p.first = i;
+        p.last = i;
+        ++p.freq;
+        enqueue(k);
+    }
+
+    /// Adds the occurrence of a digram xx at text position i if it was
+    /// skipped, unless it is the digram that is being replaced.
+    inline void add_skipped(len_t i, digram_t replaced) {
+        const len_t j = m_next[i];
+        if(j == none || linked(i) || (*m_text)[i] != (*m_text)[j]) return;
+        if(digram_at(i) != replaced) add_occurrence(i);
+    }
+
+    /// Removes the digram occurrence at text position i, if it is counted.
+    inline void remove_occurrence(len_t i) {
+        if(!linked(i)) return;
+
+        const len_t k = m_index.at(digram_at(i));
+        dequeue(k);
+
+        Pair& p = m_pairs[k];
+        if(m_occ_prev[i] != none) m_occ_next[m_occ_prev[i]] = m_occ_next[i];
+        else p.first = m_occ_next[i];
+        if(m_occ_next[i] != none) m_occ_prev[m_occ_next[i]] = m_occ_prev[i];
+        else p.last = m_occ_prev[i];
+        m_occ_prev[i] = unlinked;
+
+        if(--p.freq == 0) {
+            release(k);
+        } else {
+            enqueue(k);
+        }
+    }
+
+    inline void release(len_t k) {
+        m_index.erase(m_pairs[k].di);
+        m_free_pairs.push_back(k);
+    }
+
+    /// The most frequent digram, or none if no digram occurs twice.
+    inline len_t pop_max() {
+        const size_t last = m_bucket.size() - 1;
+        len_t max = none;
+        if(m_bucket[last] != none) {
+            // the last bucket is not sorted
+            for(len_t k = m_bucket[last]; k != none; k = m_pairs[k].next) {
+                if(max == none || m_pairs[k].freq > m_pairs[max].freq) max = k;
+            }
+        } else {
+            while(m_top >= 2 && m_bucket[m_top] == none) --m_top;
+            if(m_top >= 2) max = m_bucket[m_top];
+        }
+
+        if(max != none) dequeue(max);
+        return max;
+    }
+
+    /// Replaces all counted occurrences of the digram k by the symbol x.
+    inline size_t replace(len_t k, sym_t x) {
+        std::vector<sym_t>& text = *m_text;
+        size_t num_replaced = 0;
+
+        for(len_t i = m_pairs[k].first; i != none;) {
+            const len_t next_occ = m_occ_next[i];
+            m_occ_prev[i] = unlinked;
+
+            const len_t j = m_next[i];
+            const len_t p = m_prev[i];
+            const len_t q = m_next[j];
+            DCHECK_EQ(digram_at(i), m_pairs[k].di);
+
+            // the digrams overlapping the occurrence
+            if(p != none) remove_occurrence(p);
+            if(q != none) remove_occurrence(j);
+
+            text[i] = x;
+            m_next[i] = q;
+            if(q != none) m_prev[q] = i;
+            ++num_replaced;
+
+            if(p != none) add_occurrence(p);
+            if(q != none) add_occurrence(i);
+
+            // occurrences of xx skipped because of the removed ones
+            const digram_t di = m_pairs[k].di;
+            if(p != none && m_prev[p] != none) add_skipped(m_prev[p], di);
+            if(q != none) add_skipped(q, di);
+
+            i = next_occ;
+        }
+
+        release(k);
+        return num_replaced;
+    }
+
+public:
+    /// \param text the input text
+    inline LinearRePair(std::vector<sym_t>& text) : m_text(&text), m_top(0) {
+        const len_t n = text.size();
+        m_next.resize(n);
+        m_prev.resize(n);
+        for(len_t i = 0; i < n; ++i) {
+            m_next[i] = (i + 1 < n) ? i + 1 : none;
+            m_prev[i] = (i > 0) ? i - 1 : none;
+        }
+
+        m_occ_next.assign(n, len_t(none));
+        m_occ_prev.assign(n, len_t(unlinked));
+
+        const size_t max_bucket = std::max(size_t(std::sqrt(double(n))), size_t(2));
+        m_bucket.assign(max_bucket + 1, len_t(none));
+
+        for(len_t i = 0; i + 1 < n; ++i) add_occurrence(i);
+    }
+
+    /// Replaces the most frequent digram until none occurs twice or there
+    /// are `max_rules` rules.
+    ///
+    /// \return the number of replaced digram occurrences
+    inline size_t compute(grammar_t& grammar, size_t max_rules) {
+        size_t num_replaced = 0;
+        while(grammar.size() < max_rules) {
+            const len_t k = pop_max();
+            if(k == none) break;
+
+            const sym_t x = sigma + grammar.size();
+            grammar.push_back(m_pairs[k].di);
+            num_replaced += replace(k, x);
+        }
+        return num_replaced;
+    }
+
+    /// Replaces the text by the start rule.
+    inline void start_rule() {
+        std::vector<sym_t>& text = *m_text;
+        size_t k = 0;
+        for(len_t i = text.empty() ? none : 0; i != none; i = m_next[i]) text[k++] = text[i];
+        text.resize(k);
+    }
+};
+
+/// Computes the RePair grammar with \ref LinearRePair.
+///
+/// \param text the input text, replaced by the start rule
+/// \return the number of replaced digram occurrences
+inline size_t linear_repair(std::vector<sym_t>& text, grammar_t& grammar, size_t max_rules) {
+    LinearRePair repair(text);
+    const size_t num_replaced = repair.compute(grammar, max_rules);
+    repair.start_rule();
+    return num_replaced;
+}
+
+}} //ns
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <unordered_map>
+#include <vector>
+#include <tudocomp/compressors/repair/Grammar.hpp>
+
+namespace tdc {
+namespace repair {
+
+/// Computes the RePair grammar by counting all digrams of the text and
+/// replacing the most frequent one with a scan over the text, for each rule.
+///
+/// \param text the input text, replaced by the start rule
+/// \return the number of replaced digram occurrences
+inline size_t naive_repair(std::vector<sym_t>& text, grammar_t& grammar, size_t max_rules) {
+    const len_t n = text.size();
+    if(n == 0) return 0;
+
+    std::vector<len_t> next(n); //TODO use an int vector of required bit width
+    for(size_t i = 0; i < n; i++) next[i] = i + 1;
+
+    size_t num_replaced = 0;
+
+    while(grammar.size() < max_rules) {
+        // count digrams
+        digram_t max;
+        size_t max_count = 0;
+
+        {
+            std::unordered_map<digram_t, size_t> count;
+            // TODO: probably not optimal, but twice as fast as std::map
+
+            size_t i = 0;
+            while(i < n - 1) {
+                size_t j = next[i];
+                if(j >= n) break; // break if at end
+
+                digram_t di = digram(text[i], text[j]);
+
+                // update counter
+                size_t c = count[di] + 1;
+                count[di] = c;
+
+                // update max
+                if(c > max_count) {
+                    max = di;
+                    max_count = c;
+                }
+
+                // advance
+                i = j;
+            }
+        }
+
+        // replace most common digram (max)
+        if(max_count > 1) {
+            sym_t new_sym = sigma + grammar.size();
+            grammar.push_back(max);
+
+            size_t i = 0;
+            while(i < n - 1) {
+                size_t j = next[i];
+                if(j >= n) break; // break if at end
+
+                digram_t di = digram(text[i], text[j]);
+                if(di == max) {
+                    text[i] = new_sym; // replace symbol at i by new symbol
+                    next[i] = next[j];
+
+                    ++num_replaced;
+                }
+
+                // advance
+                i = next[i];
+            }
+        } else {
+            break; // done
+        }
+    }
+
+    // compact the start rule
+    size_t k = 0;
+    for(size_t i = 0; i < n; i = next[i]) text[k++] = text[i];
+    text.resize(k);
+
+    return num_replaced;
+}
+
+}} //ns
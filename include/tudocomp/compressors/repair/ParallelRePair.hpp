@@ -0,0 +1,327 @@
+#pragma once
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstring>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <tudocomp/util.hpp>
+#include <tudocomp/compressors/repair/Grammar.hpp>
+
+namespace tdc {
+namespace repair {
+
+/// A hash table counting the digram occurrences of one text chunk, with
+/// linear probing. The slots are allocated once, such that threads can count
+/// without allocating memory (the memory tracking of \ref StatPhase is not
+/// thread-safe). Of the allocated slots, a power of two is used, which is
+/// adapted to the chunk size by \ref clear.
+class DigramTable {
+public:
+    struct Entry {
+        digram_t di;
+        len_t count; //! 0 for an empty slot
+        len_t last; //! position of the last occurrence
+    };
+
+private:
+    std::vector<Entry> m_slots;
+    size_t m_capacity;
+    size_t m_bits;
+
+    inline static size_t capacity_for(size_t max_entries) {
+        size_t capacity = 2;
+        while(capacity < 2 * max_entries) capacity *= 2;
+        return capacity;
+    }
+
+public:
+    inline DigramTable(size_t max_entries)
+        : m_slots(capacity_for(max_entries), Entry { 0, 0, 0 })
+        , m_capacity(m_slots.size())
+        , m_bits(bits_for(m_capacity - 1)) {}
+
+    /// The number of slots in use.
+    inline size_t capacity() const {
+        return m_capacity;
+    }
+
+    /// The slot a digram is hashed to.
+    inline size_t home(digram_t di) const {
+        return size_t((di * 0x9E3779B97F4A7C15ULL) >> (64 - m_bits));
+    }
+
+    /// Removes all entries and uses as many slots as needed for
+    /// `max_entries` entries.
+    inline void clear(size_t max_entries) {
+        std::fill(m_slots.begin(), m_slots.begin() + m_capacity, Entry { 0, 0, 0 });
+        m_capacity = std::min(capacity_for(max_entries), m_slots.size());
+        m_bits = bits_for(m_capacity - 1);
+    }
+
+    inline void add(digram_t di, len_t pos) {
+        size_t s = home(di);
+        while(m_slots[s].count != 0 && m_slots[s].di != di) s = (s + 1) & (m_capacity - 1);
+        m_slots[s].di = di;
+        ++m_slots[s].count;
+        m_slots[s].last = pos;
+    }
+
+    inline const Entry* find(digram_t di) const {
+        for(size_t s = home(di); m_slots[s].count != 0; s = (s + 1) & (m_capacity - 1)) {
+            if(m_slots[s].di == di) return &m_slots[s];
+        }
+        return nullptr;
+    }
+
+    inline const Entry& slot(size_t s) const {
+        return m_slots[s & (m_capacity - 1)];
+    }
+};
+
+/// A fixed set of threads that run one job after the other, such that the
+/// threads are not created anew for each job. The calling thread takes part
+/// in each job as worker 0.
+class WorkerPool {
+    typedef std::function<void(size_t)> job_t;
+
+    std::vector<std::thread> m_workers;
+    std::mutex m_mutex;
+    std::condition_variable m_start;
+    std::condition_variable m_done;
+
+    const job_t* m_job;
+    size_t m_num; //! the number of workers of the current job
+    size_t m_pending; //! the number of workers still running the job
+    size_t m_generation; //! the number of jobs started so far
+    bool m_stop;
+
+    inline void work(size_t t) {
+        size_t generation = 0;
+        while(true) {
+            const job_t* job;
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_start.wait(lock, [&]{ return m_stop || m_generation != generation; });
+                if(m_stop) return;
+                generation = m_generation;
+                if(t >= m_num) continue;
+                job = m_job;
+            }
+
+            (*job)(t);
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if(--m_pending == 0) m_done.notify_one();
+        }
+    }
+
+public:
+    /// Starts `threads - 1` worker threads.
+    inline WorkerPool(size_t threads)
+        : m_job(nullptr), m_num(0), m_pending(0), m_generation(0), m_stop(false) {
+        for(size_t t = 1; t < threads; ++t) m_workers.emplace_back(&WorkerPool::work, this, t);
+    }
+
+    inline ~WorkerPool() {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+        m_start.notify_all();
+        for(auto& w : m_workers) w.join();
+    }
+
+    /// Runs f(t) for t in [0, num) and returns when all calls are done.
+    inline void run(size_t num, const job_t& f) {
+        DCHECK_LE(num, m_workers.size() + 1);
+        if(num > 1) {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_job = &f;
+                m_num = num;
+                m_pending = num - 1;
+                ++m_generation;
+            }
+            m_start.notify_all();
+        }
+
+        f(0);
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_done.wait(lock, [&]{ return m_pending == 0; });
+    }
+};
+
+/**
+ * Computes the same RePair grammar as \ref naive_repair with multiple threads.
+ *
+ * The text is kept compacted and split into one chunk per thread. The threads
+ * are started once, in a \ref WorkerPool. For each rule, they
+ * 1. count the digrams starting in their chunk in a table of their own,
+ * 2. merge the counts of the digrams whose hash values fall into their part
+ *    of the tables and determine the most frequent one of them, and
+ * 3. replace the most frequent digram in their chunk and compact it.
+ *
+ * A digram crossing a chunk boundary belongs to the left chunk. Whether the
+ * first position of a chunk is consumed by such a digram is determined before
+ * the chunks are replaced, looking at a run of the symbol for digrams `xx`.
+ *
+ * Of equally frequent digrams, the one whose last occurrence comes first is
+ * replaced, which is the digram the sequential scan of \ref naive_repair
+ * finds first.
+ *
+ * \param text the input text, replaced by the start rule
+ * \param min_chunk the minimum number of positions per thread
+ * \return the number of replaced digram occurrences
+ */
+inline size_t parallel_repair(std::vector<sym_t>& text, grammar_t& grammar, size_t max_rules,
+                              size_t threads, size_t min_chunk = 1ULL << 12) {
+    min_chunk = std::max(min_chunk, size_t(1));
+    auto num_threads = [&](size_t n) {
+        return std::max(size_t(1), std::min(std::max(threads, size_t(1)), n / min_chunk));
+    };
+
+    // the number of threads only decreases with the text length, and a
+    // chunk has fewer than 2 * min_chunk positions if there are fewer
+    // threads than requested
+    const size_t max_threads = num_threads(text.size());
+    const size_t max_chunk = std::min(text.size(),
+        std::max((text.size() + max_threads - 1) / max_threads, 2 * min_chunk));
+
+    // the threads are started once for all rules
+    WorkerPool pool(max_threads);
+
+    std::vector<DigramTable> tables;
+    for(size_t t = 0; t < max_threads; ++t) tables.emplace_back(max_chunk);
+
+    std::vector<size_t> bound(max_threads + 1); //! chunk boundaries
+    std::vector<DigramTable::Entry> best(max_threads); //! most frequent digram per part
+    std::vector<size_t> start(max_threads); //! first position to replace in a chunk
+    std::vector<sym_t> succ(max_threads); //! first symbol after a chunk
+    std::vector<size_t> length(max_threads); //! length of a replaced chunk
+    std::vector<size_t> replaced(max_threads);
+
+    // whether (c, last) is the better candidate than b
+    auto better = [](const DigramTable::Entry& c, const DigramTable::Entry& b) {
+        return c.count > b.count || (c.count == b.count && c.count > 0 && c.last < b.last);
+    };
+
+    size_t num_replaced = 0;
+
+    while(grammar.size() < max_rules && text.size() > 1) {
+        const size_t n = text.size();
+        const size_t num = num_threads(n);
+        for(size_t t = 0; t <= num; ++t) bound[t] = n * t / num;
+
+        // count digrams
+        pool.run(num, [&](size_t t) {
+            DigramTable& table = tables[t];
+            table.clear((n + num - 1) / num);
+            const size_t end = std::min(bound[t + 1], n - 1);
+            for(size_t i = bound[t]; i < end; ++i) {
+                table.add(digram(text[i], text[i + 1]), i);
+            }
+        });
+
+        // merge the counts of each part of the tables
+        const size_t capacity = tables[0].capacity();
+        pool.run(num, [&](size_t p) {
+            DigramTable::Entry b { 0, 0, 0 };
+            const size_t lo = (p * capacity + num - 1) / num;
+            const size_t hi = ((p + 1) * capacity + num - 1) / num;
+
+            for(size_t t = 0; t < num; ++t) {
+                // entries of the part may have been moved behind it
+                for(size_t s = lo; s < hi || tables[t].slot(s).count != 0; ++s) {
+                    const DigramTable::Entry& e = tables[t].slot(s);
+                    if(e.count == 0) continue;
+
+                    const size_t h = tables[t].home(e.di);
+                    if(h * num / capacity != p) continue;
+
+                    bool counted = false;
+                    for(size_t u = 0; u < t && !counted; ++u) {
+                        counted = tables[u].find(e.di) != nullptr;
+                    }
+                    if(counted) continue;
+
+                    DigramTable::Entry c = e;
+                    for(size_t u = t + 1; u < num; ++u) {
+                        if(auto f = tables[u].find(e.di)) {
+                            c.count += f->count;
+                            c.last = f->last;
+                        }
+                    }
+                    if(better(c, b)) b = c;
+                }
+            }
+            best[p] = b;
+        });
+
+        DigramTable::Entry max = best[0];
+        for(size_t p = 1; p < num; ++p) {
+            if(better(best[p], max)) max = best[p];
+        }
+        if(max.count <= 1) break; // done
+
+        // replace most common digram (max)
+        const sym_t new_sym = sigma + grammar.size();
+        grammar.push_back(max.di);
+        const sym_t l = left(max.di);
+        const sym_t r = right(max.di);
+
+        // determine where the chunks start before they are modified
+        for(size_t t = 0; t < num; ++t) {
+            const size_t a = bound[t];
+            bool consumed = false;
+            if(a > 0 && text[a - 1] == l && text[a] == r) {
+                if(l != r) {
+                    consumed = true;
+                } else {
+                    // the pairs of a run start at its first position
+                    size_t s = a - 1;
+                    while(s > 0 && text[s - 1] == l) --s;
+                    consumed = (a - 1 - s) % 2 == 0;
+                }
+            }
+            start[t] = consumed ? a + 1 : a;
+            succ[t] = bound[t + 1] < n ? text[bound[t + 1]] : 0;
+        }
+
+        pool.run(num, [&](size_t t) {
+            const size_t end = bound[t + 1];
+            size_t w = bound[t];
+            size_t k = 0;
+            for(size_t i = start[t]; i < end;) {
+                const bool has_next = i + 1 < n;
+                const sym_t next = (i + 1 == end) ? succ[t] : (has_next ? text[i + 1] : 0);
+                if(has_next && text[i] == l && next == r) {
+                    text[w++] = new_sym;
+                    i += 2;
+                    ++k;
+                } else {
+                    text[w++] = text[i++];
+                }
+            }
+            length[t] = w - bound[t];
+            replaced[t] = k;
+        });
+
+        // concatenate the chunks
+        size_t w = length[0];
+        num_replaced += replaced[0];
+        for(size_t t = 1; t < num; ++t) {
+            std::memmove(text.data() + w, text.data() + bound[t], length[t] * sizeof(sym_t));
+            w += length[t];
+            num_replaced += replaced[t];
+        }
+        text.resize(w);
+    }
+
+    return num_replaced;
+}
+
+}} //ns
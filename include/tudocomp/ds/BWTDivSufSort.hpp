@@ -0,0 +1,118 @@
+#pragma once
+
+#include <cstring>
+#include <vector>
+
+#include <tudocomp/ds/TextDSFlags.hpp>
+#include <tudocomp/ds/CompressMode.hpp>
+#include <tudocomp/util/divsufsort.hpp>
+
+#include <tudocomp_stat/StatPhase.hpp>
+
+namespace tdc {
+
+/// Constructs the BWT directly using divsufsort, without a suffix array.
+///
+/// The BWT is stored as one byte per character, BWT[i] = T[SA[i] - 1]
+/// (or T[n - 1] if SA[i] = 0).
+///
+/// The suffix array position of every `sample`-th suffix is kept as well,
+/// which allows the BWT to be inverted in segments (see \ref bwt::segments).
+class BWTDivSufSort: public Algorithm {
+public:
+    /// \brief The data structure's data type.
+    using data_type = std::vector<uliteral_t>;
+
+private:
+    data_type m_bwt;
+    size_t m_rate;
+    std::vector<len_t> m_samples;
+
+public:
+    inline static Meta meta() {
+        Meta m("bwt", "divsufsort");
+        m.option("sample").dynamic(1 << 16);
+        return m;
+    }
+
+    inline static ds::InputRestrictions restrictions() {
+        return ds::InputRestrictions {
+            { 0 },
+            true
+        };
+    }
+
+    template<typename textds_t>
+    inline BWTDivSufSort(Env&& env, const textds_t& t, CompressMode cm)
+        : Algorithm(std::move(env)) {
+
+        m_rate = this->env().option("sample").as_integer();
+
+        StatPhase::wrap("Construct BWT", [&]{
+            const size_t n = t.size();
+            m_bwt.resize(n);
+
+            // divbwt works with the text followed by an implicit sentinel,
+            // which is left out from its result, such that the positions
+            // in the suffix array are the positions in the BWT
+            size_t primary;
+            {
+                std::vector<saidx_t> work(n);
+                std::vector<saidx_t> samples(m_rate > 0 && n > 0 ? (n - 1) / m_rate : 0);
+                primary = divbwt(t.text(), m_bwt.data(), work, saidx_t(n),
+                                 saidx_t(m_rate), samples.data());
+                m_samples.assign(samples.begin(), samples.end());
+            }
+
+            // the text ends with its own sentinel, which is the first suffix;
+            // the row of the implicit sentinel is the first row, and the
+            // row of the whole text is at the position of the sentinel
+            if(n > 0) {
+                std::memmove(m_bwt.data(), m_bwt.data() + 1, primary - 1);
+                m_bwt[primary - 1] = t[n - 1];
+            }
+
+            StatPhase::log("size", m_bwt.size());
+        });
+    }
+
+    /// Accesses the BWT at position i.
+    inline uliteral_t operator[](size_t i) const {
+        return m_bwt[i];
+    }
+
+    /// Provides direct access to the BWT.
+    inline const uliteral_t* data() const {
+        return m_bwt.data();
+    }
+
+    inline size_t size() const {
+        return m_bwt.size();
+    }
+
+    /// The distance between two sampled suffixes, or 0 if none are sampled.
+    inline size_t sample_rate() const {
+        return m_rate;
+    }
+
+    /// The positions of the suffixes k * sample_rate() (with k >= 1) in
+    /// samples()[k - 1].
+    inline const std::vector<len_t>& samples() const {
+        return m_samples;
+    }
+
+    /// \brief Forces the data structure to relinquish its data storage.
+    inline data_type relinquish() {
+        return std::move(m_bwt);
+    }
+
+    /// \brief Creates a copy of the data structure's storage.
+    inline data_type copy() const {
+        return m_bwt;
+    }
+
+    /// The BWT is not compressed.
+    inline void compress() {}
+};
+
+} //ns
@@ -12,6 +12,7 @@
 #include <tudocomp/ds/PLCPFromPhi.hpp>
 #include <tudocomp/ds/LCPFromPLCP.hpp>
 #include <tudocomp/ds/ISAFromSA.hpp>
+#include <tudocomp/ds/BWTDivSufSort.hpp>
 
 namespace tdc {
 
@@ -25,7 +26,8 @@ template<
     typename phi_t = PhiFromSA,
     typename plcp_t = PLCPFromPhi,
     typename lcp_t = LCPFromPLCP,
-    typename isa_t = ISAFromSA
+    typename isa_t = ISAFromSA,
+    typename bwt_t = BWTDivSufSort
 >
 class TextDS : public Algorithm {
 public:
@@ -35,6 +37,7 @@ public:
     static const dsflags_t LCP = ds::LCP;
     static const dsflags_t PHI = ds::PHI;
     static const dsflags_t PLCP = ds::PLCP;
+    static const dsflags_t BWT = ds::BWT;
 
     using value_type = uliteral_t;
 
@@ -43,6 +46,7 @@ public:
     using plcp_type = plcp_t;
     using lcp_type = lcp_t;
     using isa_type = isa_t;
+    using bwt_type = bwt_t;
 
     inline static ds::InputRestrictions common_restrictions(dsflags_t flags) {
         ds::InputRestrictions rest;
@@ -52,12 +56,13 @@ public:
         if (flags & LCP)  rest |= lcp_type::restrictions();
         if (flags & PHI)  rest |= phi_type::restrictions();
         if (flags & PLCP) rest |= plcp_type::restrictions();
+        if (flags & BWT)  rest |= bwt_type::restrictions();
 
         return rest;
     };
 
 private:
-    using this_t = TextDS<sa_t, phi_t, plcp_t, lcp_t, isa_t>;
+    using this_t = TextDS<sa_t, phi_t, plcp_t, lcp_t, isa_t, bwt_t>;
 
     View m_text;
 
@@ -66,6 +71,7 @@ private:
     std::unique_ptr<plcp_t> m_plcp;
     std::unique_ptr<lcp_t> m_lcp;
     std::unique_ptr<isa_t> m_isa;
+    std::unique_ptr<bwt_t> m_bwt;
 
     dsflags_t m_ds_requested;
     CompressMode m_cm;
@@ -121,6 +127,7 @@ public:
         m.option("plcp").templated<plcp_t, PLCPFromPhi>("plcp");
         m.option("lcp").templated<lcp_t, LCPFromPLCP>("lcp");
         m.option("isa").templated<isa_t, ISAFromSA>("isa");
+        m.option("bwt").templated<bwt_t, BWTDivSufSort>("bwt");
         m.option("compress").dynamic("delayed");
         return m;
     }
@@ -170,6 +177,9 @@ public:
     inline const isa_t& require_isa(CompressMode cm = CompressMode::select) {
         return require_ds(m_isa, "isa", cm);
     }
+    inline const bwt_t& require_bwt(CompressMode cm = CompressMode::select) {
+        return require_ds(m_bwt, "bwt", cm);
+    }
 
     // inplace methods
 
@@ -198,6 +208,11 @@ public:
 
         return inplace_ds(m_isa, ISA, "isa", cm);
     }
+    inline typename bwt_t::data_type inplace_bwt(
+        CompressMode cm = CompressMode::select) {
+
+        return inplace_ds(m_bwt, BWT, "bwt", cm);
+    }
 
     // release methods
 
@@ -216,6 +231,9 @@ public:
     inline isa_t release_isa() {
         return release_ds(m_isa, ISA, "ISA");
     }
+    inline bwt_t release_bwt() {
+        return release_ds(m_bwt, BWT, "BWT");
+    }
 
 private:
     inline void discard_sa() {
@@ -233,6 +251,9 @@ private:
     inline void discard_isa() {
         discard_ds(m_isa, ISA);
     }
+    inline void discard_bwt() {
+        discard_ds(m_bwt, BWT);
+    }
 
     inline void discard_unneeded() {
         // discard unrequested structures
@@ -241,6 +262,7 @@ private:
         if(!(m_ds_requested & PLCP)) discard_plcp();
         if(!(m_ds_requested & LCP)) discard_lcp();
         if(!(m_ds_requested & ISA)) discard_isa();
+        if(!(m_ds_requested & BWT)) discard_bwt();
     }
 
 public:
@@ -283,6 +305,12 @@ public:
             if(cm == CompressMode::coherent_delayed) m_isa->compress();
         }
 
+        // Construct BWT (without the suffix array)
+        if(flags & BWT) {
+            require_bwt(cm);
+            discard_unneeded();
+        }
+
         // Compress data structures that had dependencies
         if(cm == CompressMode::coherent_delayed) {
             if(m_sa) m_sa->compress();
@@ -13,6 +13,7 @@ namespace ds {
     constexpr dsflags_t LCP  = 0x04;
     constexpr dsflags_t PHI  = 0x08;
     constexpr dsflags_t PLCP = 0x10;
+    constexpr dsflags_t BWT  = 0x20;
 
     using io::InputRestrictions;
 
@@ -1,6 +1,9 @@
 #pragma once
 
+#include <algorithm>
 #include <cstdint>
+#include <thread>
+#include <vector>
 #include <tudocomp/util/View.hpp>
 #include <tudocomp/util.hpp>
 #include <tudocomp/def.hpp>
@@ -64,33 +67,227 @@ len_t* compute_LF(const bwt_t& bwt, const size_t bwt_length) {
 }
 
 
+/// A part [begin, end) of the text that is decoded backwards, starting at the
+/// position `row` of the BWT that holds text[end - 1].
+struct Segment {
+	size_t row;
+	size_t begin, end;
+};
+
+/**
+ * Inverts BWTs of up to a given length.
+ *
+ * Each entry of the LF table stores LF[i] together with the character BWT[i]
+ * in its lowest byte, so each step of the inversion reads a single random
+ * memory location. As the steps along one LF chain depend on each other, the
+ * text is decoded in segments, of which up to `chains` are followed in turn:
+ * the next entry of each chain is prefetched while the other chains are
+ * advanced. Segments can also be decoded by several threads.
+ *
+ * The entries have 32 bits if the length is less than 2^24, otherwise 64 bits.
+ * The table is allocated once, such that threads can invert without
+ * allocating memory (the memory tracking of \ref StatPhase is not
+ * thread-safe).
+ */
+class Inverter {
+public:
+	/// No row of the BWT is omitted.
+	static constexpr size_t no_primary = SIZE_MAX;
+
+	static constexpr size_t chains = 8;
+
+private:
+	std::vector<uint32_t> m_lf32;
+	std::vector<uint64_t> m_lf64;
+
+	template<typename entry_t, typename bwt_t>
+	inline static void compute(const bwt_t& bwt, const size_t n, const size_t primary, entry_t* lf) {
+		size_t C[ULITERAL_MAX+1] { 0 };
+		for(size_t i = 0; i < n; ++i) ++C[uliteral_t(bwt[i])];
+
+		// an omitted row is the one of the sentinel, which comes first
+		size_t sum = (primary == no_primary) ? 0 : 1;
+		for(size_t c = 0; c <= ULITERAL_MAX; ++c) {
+			const size_t k = C[c];
+			C[c] = sum;
+			sum += k;
+		}
+
+		for(size_t i = 0; i < n; ++i) {
+			const uliteral_t c = bwt[i];
+			const size_t row = C[c]++;
+			lf[i] = (entry_t(row < primary ? row : row - 1) << 8) | c;
+		}
+	}
+
+	template<typename entry_t>
+	inline static void decode(const entry_t* lf, const Segment* segments, const size_t num,
+	                          uliteral_t* text) {
+		entry_t row[chains];
+		uliteral_t* pos[chains]; // the next text position is pos - 1
+		size_t remaining[chains];
+
+		size_t active = 0;
+		size_t next = 0;
+		auto load = [&](size_t c) {
+			for(; next < num; ++next) {
+				const Segment& s = segments[next];
+				if(s.begin == s.end) continue;
+				row[c] = s.row;
+				pos[c] = text + s.end;
+				remaining[c] = s.end - s.begin;
+				++next;
+				return true;
+			}
+			return false;
+		};
+		while(active < chains && load(active)) ++active;
+
+		while(active > 0) {
+			size_t steps = remaining[0];
+			for(size_t c = 1; c < active; ++c) steps = std::min(steps, remaining[c]);
+
+			for(size_t k = 0; k < steps; ++k) {
+				for(size_t c = 0; c < active; ++c) {
+					const entry_t e = lf[row[c]];
+					*--pos[c] = uliteral_t(e);
+					row[c] = e >> 8;
+					__builtin_prefetch(lf + row[c]);
+				}
+			}
+
+			// replace the finished chains by the next segments
+			for(size_t c = 0; c < active; ++c) remaining[c] -= steps;
+			for(size_t c = 0; c < active;) {
+				if(remaining[c] > 0 || load(c)) {
+					++c;
+				} else {
+					--active;
+					row[c] = row[active];
+					pos[c] = pos[active];
+					remaining[c] = remaining[active];
+				}
+			}
+		}
+	}
+
+	template<typename entry_t, typename bwt_t>
+	inline static void invert(const bwt_t& bwt, const size_t n, const size_t primary,
+	                          const Segment* segments, const size_t num,
+	                          uliteral_t* text, const size_t threads, entry_t* lf) {
+		compute(bwt, n, primary, lf);
+
+		const size_t num_threads = std::max(std::min(threads, num), size_t(1));
+		if(num_threads == 1) {
+			decode(lf, segments, num, text);
+			return;
+		}
+
+		std::vector<std::thread> workers;
+		for(size_t t = 1; t < num_threads; ++t) {
+			workers.emplace_back([=] {
+				const size_t a = num * t / num_threads;
+				const size_t b = num * (t + 1) / num_threads;
+				decode(lf, segments + a, b - a, text);
+			});
+		}
+		decode(lf, segments, num / num_threads, text);
+		for(auto& w : workers) w.join();
+	}
+
+public:
+	/// \param max_n the maximum length of an inverted BWT
+	inline Inverter(size_t max_n) {
+		if(max_n < (size_t(1) << 24)) m_lf32.resize(max_n);
+		else m_lf64.resize(max_n);
+	}
+
+	/**
+	 * Decodes the segments of the text from its BWT of length n.
+	 *
+	 * \param primary the row of the sentinel if it is left out from the BWT
+	 *        (the rows of the BWT of the text followed by an implicit
+	 *        sentinel), or \ref no_primary if the BWT contains its sentinel.
+	 * \param threads the number of threads decoding the segments
+	 */
+	template<typename bwt_t>
+	inline void invert(const bwt_t& bwt, const size_t n, const size_t primary,
+	                   const Segment* segments, const size_t num,
+	                   uliteral_t* text, const size_t threads = 1) {
+		DCHECK_LE(n, std::max(m_lf32.size(), m_lf64.size()));
+		if(m_lf64.empty()) {
+			invert(bwt, n, primary, segments, num, text, threads, m_lf32.data());
+		} else {
+			invert(bwt, n, primary, segments, num, text, threads, m_lf64.data());
+		}
+	}
+};
+
+/**
+ * Splits a text of length n into the segments [k * rate, (k + 1) * rate).
+ *
+ * \param last the position of the last character of the text in the BWT
+ * \param samples the position of the character before text position k * rate
+ *        in the BWT in samples[k - 1], for each k >= 1 with k * rate < n
+ */
+template<typename sample_t>
+inline void segments(const size_t n, const size_t last, const size_t rate,
+                     const sample_t* samples, std::vector<Segment>& out) {
+	out.clear();
+	if(n == 0) return;
+	if(rate == 0) {
+		out.push_back(Segment { last, 0, n });
+		return;
+	}
+	for(size_t begin = 0; begin < n; begin += rate) {
+		const size_t end = std::min(begin + rate, n);
+		out.push_back(Segment { end == n ? last : size_t(samples[end / rate - 1]), begin, end });
+	}
+}
+
 /**
  * Decodes a BWT
  * It is assumed that the BWT is stored in a container with access to operator[] and .size()
+ * If the position of every `rate`-th character is given in `samples` (see \ref segments),
+ * `threads` threads decode the text.
  */
 template<typename bwt_t>
-uliteral_t* decode_bwt(const bwt_t& bwt) {
+uliteral_t* decode_bwt(const bwt_t& bwt, const size_t rate = 0, const len_t* samples = nullptr,
+                       const size_t threads = 1) {
 	const size_t bwt_length = bwt.size();
 	VLOG(2) << "InputSize: " << bwt_length;
 	if(tdc_unlikely(bwt.empty())) return nullptr;
-	if(tdc_unlikely(bwt_length == 1)) { // since there has to be a zero in each string, a string of length 1 is equal to '\0'
-		uliteral_t*const decoded_string { new uliteral_t[1] };
-		decoded_string[0] = 0;
-		return decoded_string;
-	}
-	const len_t*const LF { compute_LF(bwt, bwt_length) };
 
 	uliteral_t*const decoded_string = new uliteral_t[bwt_length];
 	decoded_string[bwt_length-1] = 0;
-	len_t i = 0;
-	for(len_t j = 1; j < bwt_length && bwt[i] != 0; ++j) {
-		decoded_string[bwt_length - j-1] = bwt[i];
-		i = LF[i];
-		DCHECK( (bwt[i] == 0 && j+1 == bwt_length) || (bwt[i] != 0 && j+1 < bwt_length));
-	}
-	delete [] LF;
+
+	// the first row is the one of the sentinel, ending with the last character
+	std::vector<Segment> parts;
+	segments(bwt_length - 1, 0, rate, samples, parts);
+
+	Inverter inverter(bwt_length);
+	inverter.invert(bwt, bwt_length, Inverter::no_primary, parts.data(), parts.size(),
+	                decoded_string, threads);
 	return decoded_string;
 }
 
+/**
+ * Inverts the BWT of a text of length n followed by an implicit sentinel that
+ * is smaller than all characters.
+ * The BWT is stored without the sentinel, whose row `primary` (in [1, n]) is
+ * given separately.
+ */
+inline void invert_bwt(const uliteral_t* bwt, const size_t n, const size_t primary,
+                       uliteral_t* text) {
+	DCHECK(n == 0 || (primary >= 1 && primary <= n));
+
+	// the first row ends with the last character of the text
+	std::vector<Segment> parts;
+	segments(n, 0, 0, (const len_t*)nullptr, parts);
+
+	Inverter inverter(n);
+	inverter.invert(bwt, n, primary, parts.data(), parts.size(), text);
+}
+
 }}//ns
 
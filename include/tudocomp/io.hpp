@@ -4,6 +4,7 @@
 
 #include <tudocomp/io/Input.hpp>
 #include <tudocomp/io/Output.hpp>
+#include <tudocomp/io/BlockReader.hpp>
 
 #include <tudocomp/io/BitIStream.hpp>
 #include <tudocomp/io/BitOStream.hpp>
@@ -19,6 +20,9 @@ using Input = io::Input;
 /// Convenience shortcut to \ref io::Output.
 using Output = io::Output;
 
+/// Convenience shortcut to \ref io::BlockReader.
+using BlockReader = io::BlockReader;
+
 /// Convenience shortcut to \ref io::BitIStream.
 using BitIStream = io::BitIStream;
 
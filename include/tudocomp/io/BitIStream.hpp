@@ -1,8 +1,11 @@
 #pragma once
 
+#include <algorithm>
 #include <climits>
 #include <cstdint>
+#include <cstring>
 #include <iostream>
+#include <vector>
 #include <tudocomp/util.hpp>
 
 namespace tdc {
@@ -11,53 +14,91 @@ namespace io {
 /// \brief Wrapper for input streams that provides bitwise reading
 /// functionality.
 ///
-/// The current byte in the underlying input stream is buffered and processed
-/// bitwise using another cursor.
+/// The input is read in blocks into a byte buffer, from which the bits are
+/// loaded into a 64-bit window. The next bits can be inspected with \ref peek
+/// before they are consumed with \ref skip.
+///
+/// The last byte of the input stores in its lowest three bits how many bits
+/// of the last data byte are valid. If these are six or seven, the last byte
+/// only stores this number and the data ends in the byte before it
+/// (see \ref BitOStream).
 class BitIStream {
-    InputStream m_stream;
-
-    uint8_t m_current, m_next;
-
-    bool m_is_final;
-    uint8_t m_final_bits;
+    static constexpr size_t buffer_size = 1ULL << 12;
 
-    uint8_t m_cursor;
-
-    inline void read_next() {
-        const uint8_t MSB = 7;
+    InputStream m_stream;
 
-        m_current = m_next;
-        m_cursor = MSB;
+    std::vector<uint8_t> m_buffer;
+    size_t m_pos; //! the next byte to load into the window
+    size_t m_end; //! the end of the buffered bytes
+    bool m_stream_end; //! whether all bytes of the input have been buffered
+    bool m_final; //! whether the last data bits have been loaded
+
+    uint64_t m_window; //! the next bits, starting with the highest bit
+    size_t m_bits; //! the number of bits in the window
+
+    inline void fill_buffer() {
+        const size_t rest = m_end - m_pos;
+        std::memmove(m_buffer.data(), m_buffer.data() + m_pos, rest);
+        m_pos = 0;
+        m_end = rest;
+
+        const std::streamsize read = m_stream.rdbuf()->sgetn(
+            reinterpret_cast<char*>(m_buffer.data() + m_end), buffer_size - m_end);
+        m_end += std::max(read, std::streamsize(0));
+        if(m_end < buffer_size) m_stream_end = true;
+    }
 
-        char c;
-        if(m_stream.get(c)) {
-            m_next = c;
+    /// Appends the highest `bits` bits of a byte to the window.
+    inline void load(uint8_t byte, size_t bits) {
+        // the other bits are cleared, as bits behind the end read as zero
+        const uint64_t valid = byte & (0xFF00 >> bits);
+        m_window |= valid << (56 - m_bits);
+        m_bits += bits;
+    }
 
-            if(m_stream.get(c)) {
-                /*DLOG(INFO) << "read_next: ...";*/
+    /// Fills the window with at least 57 bits, or up to the end.
+    inline void refill() {
+        if(m_end - m_pos < 10 && !m_stream_end) fill_buffer();
+
+        // whole bytes, as long as eight bytes and the two bytes that may
+        // terminate the input follow
+        if(m_bits <= 56 && m_end - m_pos >= 10) {
+            uint64_t next;
+            std::memcpy(&next, m_buffer.data() + m_pos, 8);
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+            next = __builtin_bswap64(next);
+#endif
+            const size_t bytes = (64 - m_bits) / 8;
+            next >>= m_bits;
+            m_bits += 8 * bytes;
+            if(m_bits < 64) next &= ~(uint64_t(-1) >> m_bits);
+            m_window |= next;
+            m_pos += bytes;
+        }
 
-                // stream still going
-                m_stream.unget();
+        while(m_bits <= 56 && !m_final) {
+            if(m_end - m_pos < 3 && !m_stream_end) fill_buffer();
+
+            const size_t avail = m_end - m_pos;
+            if(avail >= 3) {
+                // a full byte, as it is followed by at least two bytes
+                load(m_buffer[m_pos++], 8);
+            } else if(avail == 2) {
+                const size_t final_bits = m_buffer[m_pos + 1] & 0x7;
+                if(final_bits >= 6) {
+                    load(m_buffer[m_pos], final_bits);
+                    m_pos += 2;
+                    m_final = true;
+                } else {
+                    load(m_buffer[m_pos++], 8);
+                }
             } else {
-                // stream over after next, do some checks
-                m_final_bits = c;
-                m_final_bits &= 0x7;
-                if(m_final_bits >= 6) {
-                    // special case - already final
-                    m_is_final = true;
-                    m_next = 0;
-                    /*DLOG(INFO) << "read_next: EOF*" <<
-                        ", m_final_bits := " << size_t(m_final_bits);*/
+                if(avail == 1) {
+                    load(m_buffer[m_pos], m_buffer[m_pos] & 0x7);
+                    ++m_pos;
                 }
+                m_final = true;
             }
-        } else {
-            m_is_final = true;
-            m_final_bits = m_current & 0x7;
-
-            m_next = 0;
-
-            /*DLOG(INFO) << "read_next: EOF" <<
-                ", m_final_bits := " << size_t(m_final_bits);*/
         }
     }
 
@@ -65,18 +106,16 @@ public:
     /// \brief Constructs a bitwise input stream.
     ///
     /// \param input The underlying input stream.
-    inline BitIStream(InputStream&& input) : m_stream(std::move(input)) {
-        char c;
-        if(m_stream.get(c)) {
-            m_is_final = false;
-            m_next = c;
-
-            read_next();
-        } else {
-            //empty stream
-            m_is_final = true;
-            m_final_bits = 0;
-        }
+    inline BitIStream(InputStream&& input)
+        : m_stream(std::move(input))
+        , m_buffer(buffer_size)
+        , m_pos(0)
+        , m_end(0)
+        , m_stream_end(false)
+        , m_final(false)
+        , m_window(0)
+        , m_bits(0) {
+        refill();
     }
 
     /// \brief Constructs a bitwise input stream.
@@ -85,26 +124,33 @@ public:
     inline BitIStream(Input& input) : BitIStream(input.as_stream()) {
     }
 
+    /// \brief Returns the next \c amount bits (at most 57) in MSB first
+    ///        order without consuming them. Bits behind the end are zero.
+    inline uint64_t peek(size_t amount) {
+        DCHECK_LE(amount, 57U);
+        if(m_bits < amount) refill();
+        return amount == 0 ? 0 : m_window >> (64 - amount);
+    }
+
+    /// \brief Consumes the next \c amount bits (at most 64), which must
+    ///        have been peeked before.
+    inline void skip(size_t amount) {
+        DCHECK_LE(amount, 64U);
+        amount = std::min(amount, m_bits);
+        m_window = amount < 64 ? m_window << amount : 0;
+        m_bits -= amount;
+        if(m_bits == 0) refill();
+    }
+
     /// \brief Reads the next single bit from the input.
     /// \return 1 if the next bit is set, 0 otherwise.
     inline uint8_t read_bit() {
-        /*DLOG(INFO) <<"read_bit: " <<
-                "m_is_final = " << m_is_final <<
-                ", m_final_bits = " << size_t(m_final_bits) <<
-                ", m_cursor = " << size_t(m_cursor);*/
-
-        if(!eof()) {
-            uint8_t bit = (m_current >> m_cursor) & 1;
-            if(m_cursor) {
-                --m_cursor;
-            } else {
-                read_next();
-            }
+        if(tdc_unlikely(m_bits == 0)) return 0; //EOF
 
-            return bit;
-        } else {
-            return 0; //EOF
-        }
+        const uint8_t bit = m_window >> 63;
+        m_window <<= 1;
+        if(--m_bits == 0) refill();
+        return bit;
     }
 
     /// \brief Reads the integer value of the next \c amount bits in MSB first
@@ -116,18 +162,31 @@ public:
     ///         order.
     template<class T>
     inline T read_int(size_t amount = sizeof(T) * CHAR_BIT) {
-        T value = 0;
-        for(size_t i = 0; i < amount; i++) {
-            value <<= 1;
-            value |= read_bit();
+        uint64_t value = 0;
+        while(amount > 0) {
+            const size_t bits = std::min(amount, size_t(56));
+            value = (value << bits) | peek(bits);
+            skip(bits);
+            amount -= bits;
         }
-        return value;
+        return T(value);
     }
 
     template<typename value_t>
     inline value_t read_unary() {
         value_t v = 0;
-        while(!read_bit()) ++v;
+        while(m_bits > 0) {
+            if(m_window == 0) {
+                // only zeros in the window
+                v += value_t(m_bits);
+                skip(m_bits);
+            } else {
+                const size_t zeros = __builtin_clzll(m_window);
+                v += value_t(zeros);
+                skip(zeros + 1);
+                break;
+            }
+        }
         return v;
     }
 
@@ -186,9 +245,9 @@ public:
         return T(value);
     }
 
-    /// TODO document
+    /// \brief Returns whether all bits of the input have been read.
     inline bool eof() const {
-        return m_is_final && m_cursor <= (7 - m_final_bits);
+        return m_bits == 0;
     }
 };
 
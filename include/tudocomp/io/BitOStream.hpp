@@ -1,8 +1,11 @@
 #pragma once
 
+#include <algorithm>
 #include <climits>
 #include <cstdint>
+#include <cstring>
 #include <iostream>
+#include <vector>
 #include <tudocomp/util.hpp>
 #include <tudocomp/io/Output.hpp>
 
@@ -12,36 +15,73 @@ namespace io {
 /// \brief Wrapper for output streams that provides bitwise writing
 /// functionality.
 ///
-/// Bits are written into a buffer byte, which is written to the output when
-/// it is either filled or when a flush is explicitly requested.
+/// Bits are collected in a 64-bit word, starting with its highest bit. Full
+/// words are appended to a byte buffer, which is written to the output when
+/// it is full and when the stream is destroyed.
+///
+/// Finally, the number of valid bits in the last data byte is written into
+/// the lowest three bits of the last byte. If these bits are used by the
+/// data, the number is written into a byte of its own.
 class BitOStream {
+    static constexpr size_t buffer_size = 1ULL << 12;
+
     OutputStream m_stream;
 
-    bool m_dirty;
-    uint8_t m_next;
-    int m_cursor;
+    std::vector<uint8_t> m_buffer;
+    size_t m_pos; //! the number of bytes in the buffer
+    size_t m_bytes_written; //! the number of bytes moved to the buffer
 
-    inline void reset() {
-        const int MSB = 7;
+    uint64_t m_word; //! the pending bits, starting with the highest bit
+    size_t m_bits; //! the number of pending bits
 
-        m_next = 0;
-        m_cursor = MSB;
-        m_dirty = false;
+    inline void flush_buffer() {
+        m_stream.write(reinterpret_cast<const char*>(m_buffer.data()), m_pos);
+        m_pos = 0;
     }
 
-    inline void write_next() {
-        if (m_dirty) {
-            m_stream.put(char(m_next));
-            reset();
+    /// Moves the highest `bytes` bytes of the word to the buffer.
+    inline void put_bytes(size_t bytes) {
+        if(m_pos + bytes > buffer_size) flush_buffer();
+        for(size_t i = 0; i < bytes; ++i) {
+            m_buffer[m_pos++] = uint8_t(m_word >> (56 - 8 * i));
         }
+        m_bytes_written += bytes;
+    }
+
+    inline void put_word() {
+        if(m_pos + 8 > buffer_size) flush_buffer();
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+        const uint64_t big_endian = __builtin_bswap64(m_word);
+#else
+        const uint64_t big_endian = m_word;
+#endif
+        std::memcpy(m_buffer.data() + m_pos, &big_endian, 8);
+        m_pos += 8;
+        m_bytes_written += 8;
+        m_word = 0;
+        m_bits = 0;
+    }
+
+    /// Appends the lowest `bits` bits (at most 64 - m_bits) of the value.
+    inline void append(uint64_t value, size_t bits) {
+        if(bits == 0) return;
+        value &= uint64_t(-1) >> (64 - bits);
+        m_word |= value << (64 - m_bits - bits);
+        m_bits += bits;
+        if(m_bits == 64) put_word();
     }
 
 public:
     /// \brief Constructs a bitwise output stream.
     ///
     /// \param output The underlying output stream.
-    inline BitOStream(OutputStream&& output) : m_stream(std::move(output)) {
-        reset();
+    inline BitOStream(OutputStream&& output)
+        : m_stream(std::move(output))
+        , m_buffer(buffer_size)
+        , m_pos(0)
+        , m_bytes_written(0)
+        , m_word(0)
+        , m_bits(0) {
     }
 
     /// \brief Constructs a bitwise output stream.
@@ -51,40 +91,45 @@ public:
     }
 
     ~BitOStream() {
-        char set = 7 - m_cursor;
-        if(m_cursor >= 2) {
-            m_next |= set;
+        // the full bytes, then the last partial byte with the number of its
+        // valid bits
+        const size_t set = m_bits % 8;
+        put_bytes(m_bits / 8);
+        m_word <<= m_bits - set;
+
+        if(set >= 6) {
+            put_bytes(1);
+            m_word = uint64_t(set) << 56;
         } else {
-            write_next();
-            m_next = set;
+            m_word |= uint64_t(set) << 56;
         }
-
-        m_dirty = true;
-        write_next();
+        put_bytes(1);
+        flush_buffer();
     }
 
     /// \brief Returns the output position indicator of the underlying stream,
     ///        which should equal the amount of bytes written to it.
     ///
-    /// Note that this value does not include bits that have not yet been
-    /// flushed.
+    /// Note that this value does not include bits that are still buffered.
     ///
     /// \return the output position indicator of the underlying stream
     inline auto tellp() -> decltype(m_stream.tellp()) {
         return m_stream.tellp();
     }
 
+    /// \brief Returns the amount of bits written so far, including the bits
+    ///        that are still buffered.
+    ///
+    /// \return the amount of bits written
+    inline size_t bits_written() const {
+        return m_bytes_written * CHAR_BIT + m_bits;
+    }
+
     /// \brief Writes a single bit to the output.
     /// \param set The bit value (0 or 1).
     inline void write_bit(bool set) {
-        if (set) {
-            m_next |= (1 << m_cursor);
-        }
-
-        m_dirty = true;
-        if (--m_cursor < 0) {
-            write_next();
-        }
+        m_word |= uint64_t(set) << (63 - m_bits);
+        if(++m_bits == 64) put_word();
     }
 
     /// Writes the bit representation of an integer in MSB first order to
@@ -96,17 +141,31 @@ public:
     ///             this equals the bit width of type \c T.
     template<class T>
     inline void write_int(T value, size_t bits = sizeof(T) * CHAR_BIT) {
-        for (int i = bits - 1; i >= 0; i--) {
-            write_bit((value & T(T(1) << i)) != T(0));
+        // bits above the width of the value are zero
+        while(bits > 64) {
+            const size_t zeros = std::min(bits - 64, 64 - m_bits);
+            append(0, zeros);
+            bits -= zeros;
+        }
+
+        const uint64_t v = uint64_t(value);
+        const size_t free = 64 - m_bits;
+        if(bits <= free) {
+            append(v, bits);
+        } else {
+            append(v >> (bits - free), free);
+            append(v, bits - free);
         }
     }
 
     template<typename value_t>
     inline void write_unary(value_t v) {
-        while(v--) {
-            write_bit(0);
+        uint64_t zeros = uint64_t(v);
+        while(zeros >= 64 - m_bits) {
+            zeros -= 64 - m_bits;
+            put_word();
         }
-
+        m_bits += zeros;
         write_bit(1);
     }
 
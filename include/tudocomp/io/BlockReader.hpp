@@ -0,0 +1,92 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include <tudocomp/io/Input.hpp>
+
+namespace tdc {namespace io {
+    /// \brief Reads an input block by block.
+    ///
+    /// Compressors that scan their input once can read the characters from
+    /// contiguous blocks instead of calling the `std::istream` interface of
+    /// an \ref InputStream for each character.
+    ///
+    /// If the input is a view on memory, there is only one block, which is a
+    /// view on the input without any copy. Files and streams are read into a
+    /// buffer of `block_size` bytes, such that they are read in constant
+    /// memory.
+    class BlockReader {
+        std::unique_ptr<InputView> m_view;
+        std::unique_ptr<InputStream> m_stream;
+        std::vector<uliteral_t> m_buffer;
+
+        const uliteral_t* m_pos;
+        const uliteral_t* m_end;
+
+        /// Reads the next block of the stream.
+        /// Returns false if the input is exhausted.
+        inline bool refill() {
+            if(!m_stream) return false;
+
+            const std::streamsize read = m_stream->rdbuf()->sgetn(
+                reinterpret_cast<char*>(m_buffer.data()), m_buffer.size());
+            m_pos = m_buffer.data();
+            m_end = m_pos + std::max<std::streamsize>(read, 0);
+            return m_pos != m_end;
+        }
+
+    public:
+        static constexpr size_t default_block_size = 1ULL << 16;
+
+        inline BlockReader(const Input& input, size_t block_size = default_block_size) {
+            const auto& data = *input.m_data;
+
+            // a view on a file or stream, or on escaped memory, would be a
+            // copy of the whole input
+            if(data.source().is_view() && data.restrictions().has_no_restrictions()) {
+                m_view = std::make_unique<InputView>(input.as_view());
+                m_pos = m_view->data();
+                m_end = m_pos + m_view->size();
+            } else {
+                m_stream = std::make_unique<InputStream>(input.as_stream());
+                m_buffer.resize(block_size);
+                m_pos = m_end = m_buffer.data();
+            }
+        }
+
+        /// Reads the next character. Returns false at the end of the input.
+        inline bool get(uliteral_t& c) {
+            if(tdc_unlikely(m_pos == m_end) && !refill()) return false;
+            c = *m_pos++;
+            return true;
+        }
+
+        /// \copydoc get
+        inline bool get(char& c) {
+            uliteral_t u;
+            if(!get(u)) return false;
+            c = u;
+            return true;
+        }
+
+        /// Reads the next character without consuming it.
+        /// Returns false at the end of the input.
+        inline bool peek(uliteral_t& c) {
+            if(tdc_unlikely(m_pos == m_end) && !refill()) return false;
+            c = *m_pos;
+            return true;
+        }
+
+        /// Consumes and returns the unread characters of the current block,
+        /// or the next block if all of them were read.
+        /// Returns an empty view at the end of the input.
+        inline View next_block() {
+            if(m_pos == m_end) refill();
+            const View block(m_pos, m_end - m_pos);
+            m_pos = m_end;
+            return block;
+        }
+    };
+}}
+
@@ -111,6 +111,7 @@ namespace tdc {namespace io {
         friend class InputStream;
         friend class InputStreamInternal;
         friend class InputView;
+        friend class BlockReader;
 
         std::shared_ptr<Variant> m_data;
     public:
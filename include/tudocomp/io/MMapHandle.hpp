@@ -5,6 +5,7 @@
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <unistd.h>
+#include <cstdlib>
 
 #include <tudocomp_stat/malloc.hpp>
 #include <tudocomp/def.hpp>
@@ -199,6 +200,46 @@ namespace tdc {namespace io {
             })
         }
 
+        /// Create a writable memory map of length `size` that is backed by
+        /// a new temporary file in the directory `dir`.
+        ///
+        /// The kernel is free to write pages of such a mapping back to the
+        /// file, so it does not need to fit into main memory.
+        /// The file gets unlinked right away and vanishes
+        /// together with the mapping.
+        inline static MMap temporary_file(size_t size,
+                                          const std::string& dir = "/tmp")
+        {
+            std::string path = dir + "/tudocomp_XXXXXX";
+            auto fd = mkstemp(&path[0]);
+            CHECK(fd != -1) << "Error at creating temporary file in " << dir;
+            unlink(path.c_str());
+
+            {
+                auto ret = ftruncate(fd, adj_size(size));
+                if (ret == -1) {
+                    perror("Resizing temporary file");
+                }
+                CHECK(ret != -1);
+            }
+
+            void* ptr = mmap(NULL,
+                             adj_size(size),
+                             PROT_READ | PROT_WRITE,
+                             MAP_SHARED,
+                             fd,
+                             0);
+            close(fd);
+            check_mmap_error(ptr, "mapping temporary file into memory");
+
+            MMap r;
+            r.m_ptr = (uint8_t*) ptr;
+            r.m_size = size;
+            r.m_mode = Mode::ReadWrite;
+            r.m_state = State::Shared;
+            return r;
+        }
+
         /// Changes the size of this mapping.
         ///
         /// Only works if the mapping is in read-write mode.
@@ -226,7 +267,7 @@ namespace tdc {namespace io {
         GenericView<uint8_t> view() {
             const auto err = "Attempting to get a mutable view into a read-only mapping. Call the const overload of view() instead"_v;
 
-            DCHECK(m_state == State::Private) << err;
+            DCHECK(m_state != State::Unmapped) << err;
             DCHECK(m_mode == Mode::ReadWrite) << err;
             return GenericView<uint8_t>(m_ptr, m_size);
         }
@@ -28,6 +28,9 @@
 
 #pragma once
 
+#include <cassert>
+#include <vector>
+
 #include <tudocomp/util/divsufsort_def.hpp>
 #include <tudocomp/util/divsufsort_private.hpp>
 #include <tudocomp/util/divsufsort_ssort.hpp>
@@ -225,6 +228,84 @@ inline void construct_SA(
   }
 }
 
+// from divsufsort.c
+/* Constructs the burrows-wheeler transformed string directly
+   by using the sorted order of type B* suffixes.
+   sample(s, i) is called (at least once) with the position i of each
+   suffix s in the suffix array. */
+template<typename buffer_t, typename sample_t>
+inline saidx_t construct_BWT(
+        const sauchar_t *T, buffer_t& SA,
+              saidx_t *bucket_A, saidx_t *bucket_B,
+              saidx_t n, saidx_t m, sample_t sample) {
+
+  saidx_t i, j, k, orig;
+  saidx_t s, t;
+  saint_t c0, c1, c2;
+
+  if(0 < m) {
+    /* Construct the sorted order of type B suffixes by using
+       the sorted order of type B* suffixes. */
+    for(c1 = ALPHABET_SIZE - 2; 0 <= c1; --c1) {
+      /* Scan the suffix array from right to left. */
+      for(i = BUCKET_BSTAR(c1, c1 + 1),
+          j = BUCKET_A(c1 + 1) - 1, k = -1, c2 = -1;
+          i <= j;
+          --j) {
+        if(0 < (s = SA[j])) {
+          assert(T[s] == c1);
+          assert(((s + 1) < n) && (T[s] <= T[s + 1]));
+          assert(T[s - 1] <= T[s]);
+          sample(s, j);
+          c0 = T[t = --s];
+          SA[j] = ~((saidx_t)c0);
+          if((0 < s) && (T[s - 1] > c0)) { s = ~s; }
+          if(c0 != c2) {
+            if(0 <= c2) { BUCKET_B(c2, c1) = k; }
+            k = BUCKET_B(c2 = c0, c1);
+          }
+          assert(k < j);
+          sample(t, k);
+          SA[k--] = s;
+        } else if(s != 0) {
+          SA[j] = ~s;
+        } else {
+          assert(T[s] == c1);
+        }
+      }
+    }
+  }
+
+  /* Construct the BWTed string by using
+     the sorted order of type B suffixes. */
+  k = BUCKET_A(c2 = T[n - 1]);
+  sample(n - 1, k);
+  SA[k++] = (T[n - 2] < c2) ? ~((saidx_t)T[n - 2]) : (n - 1);
+  /* Scan the suffix array from left to right. */
+  for(i = 0, j = n, orig = 0; i < j; ++i) {
+    if(0 < (s = SA[i])) {
+      assert(T[s - 1] >= T[s]);
+      sample(s, i);
+      c0 = T[t = --s];
+      SA[i] = c0;
+      if((0 < s) && (T[s - 1] < c0)) { s = ~((saidx_t)T[s - 1]); }
+      if(c0 != c2) {
+        BUCKET_A(c2) = k;
+        k = BUCKET_A(c2 = c0);
+      }
+      assert(i < k);
+      sample(t, k);
+      SA[k++] = s;
+    } else if(s != 0) {
+      SA[i] = ~s;
+    } else {
+      orig = i;
+    }
+  }
+
+  return orig;
+}
+
 // the actual divsufsort execution
 template<typename buffer_t>
 inline void divsufsort_run(
@@ -258,6 +339,79 @@ inline void divsufsort_run<DynamicIntVector>(
     divsufsort_run(T, wrapSA, bucket_A, bucket_B, n);
 }
 
+// the actual divbwt execution, see divbwt
+//
+// If rate is positive, the position of each suffix k * rate (with k >= 1)
+// in the suffix array is stored in samples[k - 1].
+template<typename buffer_t>
+inline saidx_t divbwt_run(
+    const sauchar_t* T, sauchar_t* U, buffer_t& A,
+    saidx_t *bucket_A, saidx_t *bucket_B, saidx_t n,
+    saidx_t rate = 0, saidx_t* samples = nullptr) {
+
+    if(n <= 1) { if(n == 1) { U[0] = T[0]; } return n; }
+
+    // sign check
+    A[0] = -1; DCHECK(A[0] < 0) << "only signed integer buffers are supported";
+
+    saidx_t m = sort_typeBstar(T, A, bucket_A, bucket_B, n);
+    saidx_t pidx;
+    if(rate > 0) {
+        pidx = construct_BWT(T, A, bucket_A, bucket_B, n, m, [&](saidx_t s, saidx_t i) {
+            if(s > 0 && s % rate == 0) samples[s / rate - 1] = i;
+        });
+    } else {
+        pidx = construct_BWT(T, A, bucket_A, bucket_B, n, m, [](saidx_t, saidx_t) {});
+    }
+
+    /* Copy to output string. */
+    saidx_t i;
+    U[0] = T[n - 1];
+    for(i = 0; i < pidx; ++i) { U[i + 1] = (sauchar_t)A[i]; }
+    for(i += 1; i < n; ++i) { U[i] = (sauchar_t)A[i]; }
+    return pidx + 1;
+}
+
+// specialize for len_t vectors
+template<>
+inline saidx_t divbwt_run<std::vector<len_t>>(
+    const sauchar_t* T, sauchar_t* U, std::vector<len_t>& A,
+    saidx_t *bucket_A, saidx_t *bucket_B, saidx_t n,
+    saidx_t rate, saidx_t* samples) {
+
+    BufferWrapper<std::vector<len_t>> wrapA(A);
+    return divbwt_run(T, U, wrapA, bucket_A, bucket_B, n, rate, samples);
+}
+
+// from divsufsort.c
+/// Computes the BWT of T followed by an implicit sentinel that is smaller
+/// than all characters into U, leaving out the sentinel, which would be
+/// at the returned position. U may be T.
+///
+/// The working array A needs room for n entries. If rate is positive, the
+/// position of each suffix k * rate (with k >= 1) in the suffix array is
+/// stored in samples[k - 1].
+template<typename buffer_t>
+inline saidx_t divbwt(const sauchar_t* T, sauchar_t* U, buffer_t& A, saidx_t n,
+                      saidx_t rate = 0, saidx_t* samples = nullptr) {
+  saidx_t *bucket_A, *bucket_B;
+  saidx_t pidx;
+
+  /* Check arguments. */
+  if((T == NULL) || (U == NULL) || (n < 0)) { return -1; }
+
+  bucket_A = new saidx_t[BUCKET_A_SIZE];
+  bucket_B = new saidx_t[BUCKET_B_SIZE];
+
+  /* Burrows-Wheeler Transform. */
+  pidx = divbwt_run(T, U, A, bucket_A, bucket_B, n, rate, samples);
+
+  delete[] bucket_B;
+  delete[] bucket_A;
+
+  return pidx;
+}
+
 // from divsufsort.c
 template<typename buffer_t>
 inline saint_t divsufsort(const sauchar_t* T, buffer_t& SA, saidx_t n) {
@@ -291,5 +445,6 @@ inline saint_t divsufsort(const sauchar_t* T, buffer_t& SA, saidx_t n) {
 
 using libdivsufsort::saidx_t;
 using libdivsufsort::divsufsort;
+using libdivsufsort::divbwt;
 
 } //ns tdc
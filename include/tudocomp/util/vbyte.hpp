@@ -1,5 +1,6 @@
 #pragma once
 
+#include <stdexcept>
 #include <tudocomp/util.hpp>
 
 namespace tdc {
@@ -37,5 +38,36 @@ inline void write_vbyte(std::ostream& os, int_t v) {
 }
 
 
+/**
+ * Stores an integer in the vbyte-encoding at `out`.
+ * \return the number of bytes written
+ */
+template<class int_t>
+inline size_t write_vbyte(uint8_t* out, int_t v) {
+	size_t i = 0;
+	do {
+		uint8_t byte = v & 0x7F;
+		v >>= 7;
+		if(v > 0) byte |= 0x80;
+		out[i++] = byte;
+	} while(v > 0);
+	return i;
+}
+
+/**
+ * Reads an integer in the vbyte-encoding from the bytes [in, end) and
+ * advances `in` behind it.
+ */
+template<class int_t>
+inline int_t read_vbyte(const uint8_t*& in, const uint8_t* end) {
+	int_t ret = 0;
+	for(size_t shift = 0; in < end; shift += 7) {
+		const uint8_t byte = *in++;
+		ret |= int_t(byte & 0x7F) << shift;
+		if(!(byte & 0x80)) return ret;
+	}
+	throw std::runtime_error("VByte ended without reading a byte with the most significant bit equals zero.");
+}
+
 }//ns
 
@@ -1,6 +1,8 @@
 #pragma once
 
 #include <iostream>
+#include <stdexcept>
+#include <string>
 #include <getopt.h>
 
 namespace tdc_driver {
@@ -10,6 +12,7 @@ constexpr int OPT_HELP   = 1000;
 constexpr int OPT_RAW    = 1001;
 constexpr int OPT_STDIN  = 1002;
 constexpr int OPT_STDOUT = 1003;
+constexpr int OPT_EXTRACT = 1004;
 
 constexpr option OPTIONS[] = {
     {"algorithm",  required_argument, nullptr, 'a'},
@@ -24,6 +27,7 @@ constexpr option OPTIONS[] = {
     {"raw",        no_argument,       nullptr, OPT_RAW},
     {"usestdin",   no_argument,       nullptr, OPT_STDIN},
     {"usestdout",  no_argument,       nullptr, OPT_STDOUT},
+    {"extract",    required_argument, nullptr, OPT_EXTRACT},
     {0, 0, 0, 0} // termination (required last entry!!)
 };
 
@@ -69,6 +73,13 @@ public:
             << "decompress the input (instead of compressing it)"
             << endl;
 
+        // --extract=FROM:TO
+        out << right << setw(W_NOSF) << ""
+            << left << setw(W_LF) << "--extract=FROM:TO"
+            << "decompress only the positions FROM to TO - 1"
+            << endl << setw(W_INDENT) << "" << "(implies -d)"
+            << endl;
+
         // -f, --force
         out << right << setw(W_SF) << "-f" << ", "
             << left << setw(W_LF) << "--force"
@@ -132,6 +143,23 @@ public:
     }
 
 private:
+    /// Parses a range "FROM:TO" with FROM <= TO.
+    static inline bool parse_range(const std::string& s, size_t& from, size_t& to) {
+        const size_t colon = s.find(':');
+        if(colon == std::string::npos) return false;
+
+        try {
+            size_t n;
+            from = std::stoull(s.substr(0, colon), &n);
+            if(n != colon) return false;
+            to = std::stoull(s.substr(colon + 1), &n);
+            if(n != s.size() - colon - 1) return false;
+        } catch(const std::exception&) {
+            return false;
+        }
+        return from <= to;
+    }
+
     // fields
     bool m_unknown_options;
 
@@ -149,6 +177,9 @@ private:
     bool m_raw;
     bool m_decompress;
 
+    bool m_extract;
+    size_t m_extract_from, m_extract_to;
+
     bool m_stats;
     std::string m_stats_title;
 
@@ -170,6 +201,9 @@ public:
         m_stdout(false),
         m_raw(false),
         m_decompress(false),
+        m_extract(false),
+        m_extract_from(0),
+        m_extract_to(0),
         m_stats(false)
     {
         int c, option_index = 0;
@@ -226,6 +260,15 @@ public:
                     m_stdout = true;
                     break;
 
+                case OPT_EXTRACT: // --extract=<optarg>
+                    m_decompress = true;
+                    m_extract = parse_range(optarg, m_extract_from, m_extract_to);
+                    if(!m_extract) {
+                        std::cerr << "Invalid range \"" << optarg << "\"" << std::endl;
+                        m_unknown_options = true;
+                    }
+                    break;
+
                 case '?': // unknown option
                     m_unknown_options = true;
                     break;
@@ -261,6 +304,10 @@ public:
     const bool& raw = m_raw;
     const bool& decompress = m_decompress;
 
+    const bool& extract = m_extract;
+    const size_t& extract_from = m_extract_from;
+    const size_t& extract_to = m_extract_to;
+
     const bool& stats = m_stats;
     const std::string& stats_title = m_stats_title;
 
@@ -340,7 +340,12 @@ int main(int argc, char** argv) {
                 //TODO: split?
                 //selection.algorithm_env()->restart_stats("Decompress");
                 setup_time = clk::now();
-                selection.compressor().decompress(inp, out);
+                if (options.extract) {
+                    selection.compressor().extract(inp, out,
+                        options.extract_from, options.extract_to);
+                } else {
+                    selection.compressor().decompress(inp, out);
+                }
                 comp_time = clk::now();
             } else {
                 setup_time = clk::now();
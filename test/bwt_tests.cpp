@@ -0,0 +1,175 @@
+#include <gtest/gtest.h>
+
+#include <tudocomp/compressors/BWTCompressor.hpp>
+#include <tudocomp/compressors/BWTPipelineCompressor.hpp>
+#include <tudocomp/ds/bwt.hpp>
+#include <tudocomp/coders/ASCIICoder.hpp>
+#include <tudocomp/coders/HuffmanCoder.hpp>
+
+#include "test/util.hpp"
+
+using namespace tdc;
+
+/// Computes the BWT of the text followed by a sentinel by sorting its
+/// rotations, without the sentinel.
+std::string naive_bwt(const std::string& text, size_t& primary) {
+    const size_t n = text.size();
+    std::vector<size_t> rows(n + 1);
+    std::iota(rows.begin(), rows.end(), 0);
+
+    // compare the suffixes, the sentinel is the smallest character
+    std::sort(rows.begin(), rows.end(), [&](size_t a, size_t b) {
+        return std::lexicographical_compare(
+            text.begin() + a, text.end(), text.begin() + b, text.end(),
+            [](char x, char y) { return uliteral_t(x) < uliteral_t(y); });
+    });
+
+    std::string bwt;
+    for(size_t r = 0; r <= n; ++r) {
+        if(rows[r] == 0) primary = r;
+        else bwt.push_back(text[rows[r] - 1]);
+    }
+    return bwt;
+}
+
+TEST(bwt, invert) {
+    auto f = [](const std::string& text) {
+        if(text.empty()) return;
+
+        size_t primary;
+        const std::string bwt = naive_bwt(text, primary);
+        ASSERT_EQ(text.back(), bwt[0]);
+
+        std::vector<uliteral_t> decoded(text.size());
+        bwt::invert_bwt(reinterpret_cast<const uliteral_t*>(bwt.data()), bwt.size(),
+                        primary, decoded.data());
+        ASSERT_EQ(text, std::string(decoded.begin(), decoded.end()));
+    };
+    test::roundtrip_batch(f);
+    test::on_string_generators(f, 12);
+}
+
+TEST(bwt, invert_segments) {
+    auto f = [](const std::string& text) {
+        if(text.empty()) return;
+        const size_t n = text.size();
+
+        size_t primary;
+        const std::string bwt = naive_bwt(text, primary);
+        const uliteral_t* t = reinterpret_cast<const uliteral_t*>(text.data());
+
+        for(size_t rate : {1, 2, 5, 64}) {
+            // the positions of the sampled suffixes in the BWT
+            std::vector<uliteral_t> direct(n);
+            std::vector<saidx_t> work(n);
+            std::vector<saidx_t> samples((n - 1) / rate);
+            divbwt(t, direct.data(), work, saidx_t(n), saidx_t(rate), samples.data());
+
+            std::vector<len_t> positions;
+            for(saidx_t pos : samples) {
+                const size_t row = pos + 1;
+                positions.push_back(row < primary ? row : row - 1);
+                ASSERT_EQ(text[rate * positions.size() - 1], bwt[positions.back()]);
+            }
+
+            std::vector<bwt::Segment> segments;
+            bwt::segments(n, 0, rate, positions.data(), segments);
+
+            bwt::Inverter inverter(n);
+            for(size_t threads : {1, 3}) {
+                std::vector<uliteral_t> decoded(n);
+                inverter.invert(bwt, n, primary, segments.data(), segments.size(),
+                                decoded.data(), threads);
+                ASSERT_EQ(text, std::string(decoded.begin(), decoded.end()));
+            }
+        }
+    };
+    test::roundtrip_batch(f);
+    test::on_string_generators(f, 12);
+}
+
+TEST(bwt, roundtrip) {
+    for(std::string options : {"", "threads = 3",
+                               "textds = textds(bwt = divsufsort(sample = 1))",
+                               "textds = textds(bwt = divsufsort(sample = 7)), threads = 2",
+                               "textds = textds(bwt = divsufsort(sample = 0))"}) {
+        auto f = [&](const std::string& text) {
+            test::roundtrip_ex<BWTCompressor<>>(text, "", options);
+        };
+        test::roundtrip_batch(f);
+        test::on_string_generators(f, 12);
+    }
+
+    // the samples precede the BWT
+    const std::string text(100, 'a');
+    auto sampled = test::RoundTrip<BWTCompressor<>>("textds = textds(bwt = divsufsort(sample = 1))")
+        .compress(text);
+    auto unsampled = test::RoundTrip<BWTCompressor<>>("textds = textds(bwt = divsufsort(sample = 0))")
+        .compress(text);
+    ASSERT_EQ(text.size() + 1 + 2, unsampled.bytes.size());
+    ASSERT_EQ(unsampled.bytes.size() + text.size(), sampled.bytes.size());
+}
+
+TEST(bwt_pipeline, roundtrip) {
+    for(std::string block : {"1", "3", "100", "900000"}) {
+        for(std::string threads : {"1", "3"}) {
+            const std::string options = "block = " + block + ", threads = " + threads;
+            auto f = [&](const std::string& text) {
+                test::roundtrip_ex<BWTPipelineCompressor<ASCIICoder>>(text, "", options);
+                test::roundtrip_ex<BWTPipelineCompressor<HuffmanCoder>>(text, "", options);
+            };
+            test::roundtrip_batch(f);
+            test::on_string_generators(f, 12);
+        }
+    }
+}
+
+TEST(bwt_pipeline, large) {
+    std::string text;
+    for(size_t i = 0; text.size() < 500000; ++i) {
+        text += std::to_string(i * i % 7919) + " ";
+    }
+    test::roundtrip_ex<BWTPipelineCompressor<HuffmanCoder>>(text, "", "block = 100000, threads = 4");
+
+    // runs are compressed
+    auto compressed = test::RoundTrip<BWTPipelineCompressor<HuffmanCoder>>("block = 100000")
+        .compress(std::string(300000, 'a'));
+    ASSERT_LT(compressed.bytes.size(), 1000U);
+}
+
+TEST(bwt_pipeline, invalid_encoded_size) {
+    // a block of one character whose encoded size exceeds any coder output
+    std::stringstream ss;
+    for(size_t v : {1, 1, 1}) write_vbyte(ss, v);
+    write_vbyte(ss, size_t(1) << 40);
+    const std::string bytes = ss.str();
+
+    auto compressor = create_algo<BWTPipelineCompressor<HuffmanCoder>>("");
+    std::vector<uint8_t> decompressed;
+    Input in(bytes);
+    Output out(decompressed);
+    ASSERT_THROW(compressor.decompress(in, out), std::runtime_error);
+}
+
+TEST(bwt, divbwt) {
+    auto f = [](const std::string& text) {
+        if(text.empty()) return;
+
+        size_t primary;
+        const std::string expected = naive_bwt(text, primary);
+
+        const uliteral_t* t = reinterpret_cast<const uliteral_t*>(text.data());
+        std::vector<uliteral_t> bwt(text.size());
+        std::vector<saidx_t> work(text.size());
+        ASSERT_EQ(saidx_t(primary), divbwt(t, bwt.data(), work, saidx_t(text.size())));
+        ASSERT_EQ(expected, std::string(bwt.begin(), bwt.end()));
+
+        // with an unsigned working array, in place
+        std::vector<uliteral_t> inplace(text.begin(), text.end());
+        std::vector<len_t> unsigned_work(text.size());
+        ASSERT_EQ(saidx_t(primary), divbwt(inplace.data(), inplace.data(), unsigned_work, saidx_t(text.size())));
+        ASSERT_EQ(expected, std::string(inplace.begin(), inplace.end()));
+    };
+    test::roundtrip_batch(f);
+    test::on_string_generators(f, 12);
+}
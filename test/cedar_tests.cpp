@@ -8,6 +8,8 @@
 #include <tudocomp/compressors/lz78/BinaryTrie.hpp>
 #include <tudocomp/compressors/lz78/TernaryTrie.hpp>
 #include <tudocomp/compressors/lz78/CedarTrie.hpp>
+#include <tudocomp/compressors/lz78/CompactHashTrie.hpp>
+#include <tudocomp/compressors/lz78/IncrementalHashTrie.hpp>
 #include <tudocomp/coders/ASCIICoder.hpp>
 #include <tudocomp/coders/BitCoder.hpp>
 
@@ -59,6 +61,24 @@ INSTANTIATE_TEST_CASE_P(
     )
 );
 
+class CompactHashLz78Compress: public ::testing::TestWithParam<InputOutput> {};
+TEST_P(CompactHashLz78Compress, test) {
+    auto c = create_algo<LZ78Compressor<ASCIICoder, lz78::CompactHashTrie>>();
+    test::TestInput i(GetParam().in, false);
+    test::TestOutput o(false);
+    c.compress(i, o);
+    ASSERT_EQ(o.result(), GetParam().out);
+}
+INSTANTIATE_TEST_CASE_P(
+    InputOutput, CompactHashLz78Compress, ::testing::Values(
+        InputOutput { "aababcabcdabcde"_v, "0:a1:b2:c3:d4:e\0"_v },
+        InputOutput { "aababcabcdabcdeabc"_v, "0:a1:b2:c3:d4:e2:c\0"_v },
+        InputOutput { "\0\0b\0bc\0bcd\0bcde"_v, "0:\0""1:b2:c3:d4:e\0"_v },
+        InputOutput { "\xfe\xfe""b\xfe""bc\xfe""bcd\xfe""bcde"_v, "0:\xfe""1:b2:c3:d4:e\0"_v },
+        InputOutput { "\xff\xff""b\xff""bc\xff""bcd\xff""bcde"_v, "0:\xff""1:b2:c3:d4:e\0"_v }
+    )
+);
+
 class NotCedarLzwCompress: public ::testing::TestWithParam<InputOutput> {};
 TEST_P(NotCedarLzwCompress, test) {
     auto c = create_algo<LZWCompressor<ASCIICoder, lz78::BinaryTrie>>();
@@ -102,6 +122,102 @@ INSTANTIATE_TEST_CASE_P(InputOutput,
                             InputOutput { "\xff\xff\xff"_v, "255:256:\0"_v }
                         ));
 
+class CompactHashLzwCompress: public ::testing::TestWithParam<InputOutput> {};
+TEST_P(CompactHashLzwCompress, test) {
+    auto c = create_algo<LZWCompressor<ASCIICoder, lz78::CompactHashTrie>>();
+    test::TestInput i(GetParam().in, false);
+    test::TestOutput o(false);
+    c.compress(i, o);
+    ASSERT_EQ(o.result(), GetParam().out);
+}
+INSTANTIATE_TEST_CASE_P(InputOutput,
+                        CompactHashLzwCompress,
+                        ::testing::Values(
+                            InputOutput { "aaaaaa"_v, "97:256:257:\0"_v },
+                            InputOutput { "aaaaaaa"_v, "97:256:257:97:\0"_v },
+                            InputOutput { "a\0b"_v, "97:0:98:\0"_v },
+                            InputOutput { "a\xfe""b"_v, "97:254:98:\0"_v },
+                            InputOutput { "a\xff""b"_v, "97:255:98:\0"_v },
+                            InputOutput { "\0\0\0"_v, "0:256:\0"_v },
+                            InputOutput { "\xfe\xfe\xfe"_v, "254:256:\0"_v },
+                            InputOutput { "\xff\xff\xff"_v, "255:256:\0"_v }
+                        ));
+
+class IncrementalHashLzwCompress: public ::testing::TestWithParam<InputOutput> {};
+TEST_P(IncrementalHashLzwCompress, test) {
+    auto c = create_algo<LZWCompressor<ASCIICoder, lz78::IncrementalHashTrie>>();
+    test::TestInput i(GetParam().in, false);
+    test::TestOutput o(false);
+    c.compress(i, o);
+    ASSERT_EQ(o.result(), GetParam().out);
+}
+INSTANTIATE_TEST_CASE_P(InputOutput,
+                        IncrementalHashLzwCompress,
+                        ::testing::Values(
+                            InputOutput { "aaaaaa"_v, "97:256:257:\0"_v },
+                            InputOutput { "aaaaaaa"_v, "97:256:257:97:\0"_v },
+                            InputOutput { "a\0b"_v, "97:0:98:\0"_v },
+                            InputOutput { "\0\0\0"_v, "0:256:\0"_v },
+                            InputOutput { "\xff\xff\xff"_v, "255:256:\0"_v }
+                        ));
+
+// the dictionary grows through several incremental resizes
+TEST(IncrementalHashTrie, lzw_matches_binary_trie) {
+    std::string text;
+    for(size_t i = 0; text.size() < 200000; ++i) {
+        text += std::to_string(i * i % 7919);
+    }
+
+    auto expected_c = create_algo<LZWCompressor<ASCIICoder, lz78::BinaryTrie>>();
+    test::TestInput expected_i(text, false);
+    test::TestOutput expected_o(false);
+    expected_c.compress(expected_i, expected_o);
+
+    auto c = create_algo<LZWCompressor<ASCIICoder, lz78::IncrementalHashTrie>>();
+    test::TestInput i(text, false);
+    test::TestOutput o(false);
+    c.compress(i, o);
+
+    ASSERT_EQ(o.result(), expected_o.result());
+}
+
+template<class comp_t>
+void dict_policy_roundtrip(const std::string& options) {
+    auto f = [&](const std::string& text) {
+        test::roundtrip_ex<comp_t>(text, "", options);
+    };
+    test::roundtrip_batch(f);
+    test::on_string_generators(f, 15);
+
+    std::string text;
+    for(size_t i = 0; text.size() < 50000; ++i) {
+        text += std::to_string(i * i % 7919);
+        text.push_back(char(i % 251));
+    }
+    f(text);
+}
+
+TEST(DictPolicy, lz78_reset) {
+    dict_policy_roundtrip<LZ78Compressor<BitCoder, lz78::BinaryTrie>>("dict_size = 50, dict_policy = \"reset\"");
+}
+TEST(DictPolicy, lz78_freeze) {
+    dict_policy_roundtrip<LZ78Compressor<BitCoder, lz78::BinaryTrie>>("dict_size = 50, dict_policy = \"freeze\"");
+}
+TEST(DictPolicy, lz78_prune) {
+    dict_policy_roundtrip<LZ78Compressor<BitCoder, lz78::BinaryTrie>>("dict_size = 50, dict_policy = \"prune\"");
+    dict_policy_roundtrip<LZ78Compressor<BitCoder, lz78::CedarTrie>>("dict_size = 2, dict_policy = \"prune\"");
+}
+TEST(DictPolicy, lzw_reset) {
+    dict_policy_roundtrip<LZWCompressor<BitCoder, lz78::BinaryTrie>>("dict_size = 300, dict_policy = \"reset\"");
+}
+TEST(DictPolicy, lzw_freeze) {
+    dict_policy_roundtrip<LZWCompressor<BitCoder, lz78::BinaryTrie>>("dict_size = 300, dict_policy = \"freeze\"");
+}
+TEST(DictPolicy, lzw_prune) {
+    dict_policy_roundtrip<LZWCompressor<BitCoder, lz78::BinaryTrie>>("dict_size = 300, dict_policy = \"prune\"");
+    dict_policy_roundtrip<LZWCompressor<BitCoder, lz78::CedarTrie>>("dict_size = 270, dict_policy = \"prune\"");
+}
+
 /*
 TEST(zcedar, base) {
     cedar::da<uint32_t> trie;
@@ -9,6 +9,7 @@
 #include <tudocomp/generators/FibonacciGenerator.hpp>
 #include <tudocomp/generators/ThueMorseGenerator.hpp>
 
+#include <tudocomp/coders/ANSCoder.hpp>
 #include <tudocomp/coders/ASCIICoder.hpp>
 #include <tudocomp/coders/EliasDeltaCoder.hpp>
 #include <tudocomp/coders/EliasGammaCoder.hpp>
@@ -215,6 +216,52 @@ TEST(coder, huff_int) { test_int<HuffmanCoder>(); }
 TEST(coder, huff_str) { test_str<HuffmanCoder>(); }
 TEST(coder, huff_mixed) { test_mixed<HuffmanCoder>(); }
 
+TEST(coder, ans_mt) { test_mt<ANSCoder>(); }
+TEST(coder, ans_bits) { test_bits<ANSCoder>(); }
+TEST(coder, ans_int) { test_int<ANSCoder>(); }
+TEST(coder, ans_str) { test_str<ANSCoder>(); }
+TEST(coder, ans_mixed) { test_mixed<ANSCoder>(); }
+
+TEST(coder, ans_blocks) {
+    // interleave literals with other values across several blocks, whose
+    // values are held back until the literals are encoded
+    std::string word = FibonacciGenerator::generate(28);
+    word += std::string(ANSCoder::block_values, 'b');
+    for(size_t i = 0; i < word.size(); i += 1000) word[i] = 'c';
+
+    for(size_t precision : { 8, 14, 16 }) {
+        auto opts = "precision=" + std::to_string(precision);
+
+        std::stringstream ss;
+        {
+            Output out(ss);
+            typename ANSCoder::Encoder coder(create_env(ANSCoder::meta(), opts), out, ViewLiterals(word));
+            for(size_t i = 0; i < word.size(); i++) {
+                coder.encode(i, size_r);
+                coder.encode(word[i], literal_r);
+                if(i >= ANSCoder::block_literals) coder.encode(word[i] == 'b', bit_r);
+            }
+            coder.encode(size_t(42), Range(100));
+        }
+
+        std::string result = ss.str();
+        {
+            Input in(result);
+            typename ANSCoder::Decoder decoder(create_env(ANSCoder::meta(), opts), in);
+            for(size_t i = 0; i < word.size(); i++) {
+                ASSERT_EQ(i, decoder.template decode<size_t>(size_r));
+                ASSERT_EQ(word[i], decoder.template decode<uliteral_t>(literal_r)) << "i=" << i;
+                if(i >= ANSCoder::block_literals) {
+                    ASSERT_EQ(word[i] == 'b', decoder.template decode<bool>(bit_r));
+                }
+            }
+            ASSERT_FALSE(decoder.eof());
+            ASSERT_EQ(42U, decoder.template decode<size_t>(Range(100)));
+            ASSERT_TRUE(decoder.eof());
+        }
+    }
+}
+
 TEST(coder, arithm_mt) { test_mt<ArithmeticCoder>(); }
 TEST(coder, arithm_bits) { test_bits<ArithmeticCoder>(); }
 TEST(coder, arithm_int) { test_int<ArithmeticCoder>(); }
@@ -56,6 +56,13 @@ void test_bwt(const std::string& str, textds_t& t) {
 	for(size_t i = 0; i < input_size; ++i) {
 		bwt.push_back(bwt::bwt(str,sa,i));
 	}
+
+	// constructed directly
+	auto& direct = t.require_bwt();
+	ASSERT_EQ(input_size, direct.size());
+	for(size_t i = 0; i < input_size; ++i) {
+		ASSERT_EQ(uliteral_t(bwt[i]), direct[i]);
+	}
 	uliteral_t* decoded_string = bwt::decode_bwt(bwt);
 	if(decoded_string == nullptr) {
 		ASSERT_EQ(str.length(), 0);
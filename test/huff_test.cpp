@@ -5,6 +5,8 @@
 #include <bitset>
 #include <algorithm>
 #include <tudocomp/coders/HuffmanCoder.hpp>
+#include <tudocomp/CreateAlgorithm.hpp>
+#include <tudocomp/Literal.hpp>
 
 void test_huffmantable_storing(const std::string& text) {
 	using namespace tdc::huff;
@@ -136,6 +138,43 @@ TEST(huffman, stringgenerators) {
 //
 // }
 
+TEST(huffman, long_codewords) {
+	// Fibonacci frequencies give codewords longer than the decoding table
+	std::string text;
+	size_t a = 1, b = 1;
+	for(char c = 'a'; c <= 'x'; ++c) {
+		text += std::string(a, c);
+		std::swap(a, b);
+		b += a;
+	}
+	std::random_shuffle(text.begin(), text.end());
+	ASSERT_GT(tdc::huff::gen_huffmantable(text).longest, 11);
+
+	test_huff(text);
+
+	// through the coder interface, mixed with other values
+	using namespace tdc;
+	std::stringstream ss;
+	{
+		Output out(ss);
+		HuffmanCoder::Encoder coder(create_env(HuffmanCoder::meta()), out, ViewLiterals(text));
+		for(char c : text) {
+			coder.encode(c, literal_r);
+			coder.encode(c == 'a', bit_r);
+		}
+	}
+	const std::string encoded = ss.str();
+	{
+		Input in(encoded);
+		HuffmanCoder::Decoder decoder(create_env(HuffmanCoder::meta()), in);
+		for(char c : text) {
+			ASSERT_EQ(c, decoder.template decode<char>(literal_r));
+			ASSERT_EQ(c == 'a', decoder.template decode<bool>(bit_r));
+		}
+		ASSERT_TRUE(decoder.eof());
+	}
+}
+
 TEST(huff, nullbyte) {
     test_huff("hel\0lo"_v);
     test_huff("hello\0"_v);
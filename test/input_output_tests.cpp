@@ -8,6 +8,7 @@
 #include <glog/logging.h>
 
 #include <tudocomp/io/Input.hpp>
+#include <tudocomp/io/BlockReader.hpp>
 #include <tudocomp/io/Output.hpp>
 
 #include "test/util.hpp"
@@ -376,6 +377,25 @@ TEST(Input, from_stream_sanity) {
     ASSERT_EQ(ss.str(), direct_cases[0].escaped_str);
 }
 
+TEST(BlockReader, file) {
+    // a file is read in blocks, not mapped or copied as a whole
+    std::string text;
+    for(size_t i = 0; i < 100000; i++) text.push_back('a' + (i * i) % 26);
+    test::write_test_file("block_reader.txt", text);
+
+    Input i = Input::from_path(test::test_file_path("block_reader.txt"));
+    io::BlockReader x(i, 4096);
+    std::string s;
+    size_t blocks = 0;
+    for(View b = x.next_block(); !b.empty(); b = x.next_block()) {
+        ASSERT_LE(b.size(), 4096U);
+        s.append(b.begin(), b.end());
+        ++blocks;
+    }
+    ASSERT_EQ(text, s);
+    ASSERT_GE(blocks, text.size() / 4096);
+}
+
 void input_equal(const Input& i, const View& str) {
     {
         auto x = i.as_view();
@@ -395,6 +415,22 @@ void input_equal(const Input& i, const View& str) {
         ASSERT_EQ(is, should_be);
         //std::cout << "    Stream Ok\n";
     }
+    {
+        io::BlockReader x(i, 3);
+        std::string s;
+        uliteral_t c, p;
+        while(x.peek(p)) {
+            ASSERT_TRUE(x.get(c));
+            ASSERT_EQ(c, p);
+            s.push_back(c);
+        }
+        ASSERT_FALSE(x.get(c));
+
+        auto is = vec_to_debug_string(s, 3);
+        auto should_be = vec_to_debug_string(str, 3);
+        ASSERT_EQ(is, should_be);
+        //std::cout << "    BlockReader Ok\n";
+    }
 }
 
 struct Direct {
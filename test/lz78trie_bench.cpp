@@ -0,0 +1,182 @@
+/// Measures the per-byte cost of the LZ78 tries.
+///
+/// For each trie, the LZ78 factorization loop is run twice: once calling the
+/// trie directly, as the compressors do, and once through a virtual
+/// interface, which is how the tries were called before `LZ78Trie` became a
+/// static contract.
+///
+/// Usage: lz78trie_bench [file]
+/// Without a file, a generated text of 16 MiB is factorized.
+
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <tudocomp/config.h>
+#include <tudocomp/Algorithm.hpp>
+#include <tudocomp/CreateAlgorithm.hpp>
+#include <tudocomp/compressors/lz78/BinarySortedTrie.hpp>
+#include <tudocomp/compressors/lz78/BinaryTrie.hpp>
+#include <tudocomp/compressors/lz78/HashTrie.hpp>
+#include <tudocomp/compressors/lz78/MyHashTrie.hpp>
+#include <tudocomp/compressors/lz78/TernaryTrie.hpp>
+#include <tudocomp/compressors/lz78/CedarTrie.hpp>
+#include <tudocomp/compressors/lz78/CompactHashTrie.hpp>
+#include <tudocomp/compressors/lz78/IncrementalHashTrie.hpp>
+#ifdef JUDY_H_AVAILABLE
+#include <tudocomp/compressors/lz78/JudyTrie.hpp>
+#endif
+
+using namespace tdc;
+
+volatile size_t g_sink; // keeps the benchmarked results alive
+
+/// The former dynamic interface of the LZ78 tries.
+template<typename search_pos>
+class VirtualTrie {
+public:
+    using node_t = lz78::TrieNode<search_pos>;
+
+    virtual ~VirtualTrie() {}
+    virtual node_t add_rootnode(uliteral_t c) = 0;
+    virtual node_t get_rootnode(uliteral_t c) = 0;
+    virtual node_t find_or_insert(const node_t& parent, uliteral_t c) = 0;
+    virtual lz78::factorid_t size() const = 0;
+};
+
+template<typename trie_t, typename search_pos>
+class VirtualTrieAdapter : public VirtualTrie<search_pos> {
+    trie_t& m_trie;
+public:
+    using node_t = lz78::TrieNode<search_pos>;
+
+    VirtualTrieAdapter(trie_t& trie) : m_trie(trie) {}
+
+    node_t add_rootnode(uliteral_t c) override {
+        return m_trie.add_rootnode(c);
+    }
+    node_t get_rootnode(uliteral_t c) override {
+        return m_trie.get_rootnode(c);
+    }
+    node_t find_or_insert(const node_t& parent, uliteral_t c) override {
+        return m_trie.find_or_insert(parent, c);
+    }
+    lz78::factorid_t size() const override {
+        return m_trie.size();
+    }
+};
+
+/// The factorization loop of LZ78Compressor, without encoding.
+template<typename dict_t>
+size_t factorize(dict_t& dict, const std::string& text) {
+    using node_t = typename dict_t::node_t;
+
+    dict.add_rootnode(0);
+    node_t node = dict.get_rootnode(0);
+    size_t factors = 0;
+
+    for(const char c : text) {
+        const node_t child = dict.find_or_insert(node, static_cast<uliteral_t>(c));
+        if(child.id() == lz78::undef_id) {
+            ++factors;
+            node = dict.get_rootnode(0);
+        } else {
+            node = child;
+        }
+    }
+    return factors;
+}
+
+template<typename F>
+double ns_per_byte(const std::string& text, F f) {
+    const auto start = std::chrono::steady_clock::now();
+    const size_t factors = f();
+    const auto end = std::chrono::steady_clock::now();
+
+    g_sink = factors;
+
+    return std::chrono::duration<double, std::nano>(end - start).count()
+        / std::max<size_t>(text.size(), 1);
+}
+
+template<typename trie_t>
+void bench(const std::string& name, const std::string& text) {
+    using search_pos = decltype(std::declval<typename trie_t::node_t>().search_pos());
+    using search_pos_t = typename std::decay<search_pos>::type;
+
+    const double direct = ns_per_byte(text, [&] {
+        trie_t dict = create_algo<trie_t>("", isqrt(text.size()) * 2);
+        return factorize(dict, text);
+    });
+
+    const double dynamic = ns_per_byte(text, [&] {
+        trie_t dict = create_algo<trie_t>("", isqrt(text.size()) * 2);
+        VirtualTrieAdapter<trie_t, search_pos_t> adapter(dict);
+
+        // hide the dynamic type from the optimizer
+        VirtualTrie<search_pos_t>* volatile ptr = &adapter;
+        return factorize(*ptr, text);
+    });
+
+    std::cout << std::left << std::setw(16) << name
+              << std::right << std::fixed << std::setprecision(2)
+              << std::setw(12) << direct
+              << std::setw(12) << dynamic
+              << std::endl;
+}
+
+std::string generate_text(size_t n) {
+    // words of a skewed alphabet, such that the trie becomes reasonably deep
+    std::mt19937 gen(n);
+    std::geometric_distribution<int> letter(0.3);
+    std::uniform_int_distribution<int> word(2, 12);
+
+    std::string text;
+    text.reserve(n);
+    while(text.size() < n) {
+        for(int i = word(gen); i > 0 && text.size() < n; --i) {
+            text.push_back('a' + std::min(letter(gen), 25));
+        }
+        if(text.size() < n) text.push_back(' ');
+    }
+    return text;
+}
+
+int main(int argc, char** argv) {
+    std::string text;
+    if(argc > 1) {
+        std::ifstream file(argv[1], std::ios::binary);
+        if(!file) {
+            std::cerr << "cannot open " << argv[1] << std::endl;
+            return 1;
+        }
+        text.assign(std::istreambuf_iterator<char>(file),
+                    std::istreambuf_iterator<char>());
+    } else {
+        text = generate_text(16ULL << 20);
+    }
+
+    std::cout << "text size: " << text.size() << " bytes" << std::endl;
+    std::cout << std::left << std::setw(16) << "trie"
+              << std::right
+              << std::setw(12) << "ns/B"
+              << std::setw(12) << "virtual" << std::endl;
+
+    bench<lz78::BinarySortedTrie>("binarysorted", text);
+    bench<lz78::BinaryTrie>("binary", text);
+    bench<lz78::HashTrie>("hash", text);
+    bench<lz78::MyHashTrie>("myhash", text);
+    bench<lz78::TernaryTrie>("ternary", text);
+    bench<lz78::CedarTrie>("cedar", text);
+    bench<lz78::CompactHashTrie>("compact_hash", text);
+    bench<lz78::IncrementalHashTrie>("incremental", text);
+#ifdef JUDY_H_AVAILABLE
+    bench<lz78::JudyTrie>("judy", text);
+#endif
+
+    return 0;
+}
@@ -7,10 +7,21 @@
 #include <tudocomp/compressors/lzss/LZSSCoding.hpp>
 #include <tudocomp/compressors/lzss/LZSSFactors.hpp>
 #include <tudocomp/compressors/lzss/LZSSLiterals.hpp>
+#include <tudocomp/compressors/lzss/LZSSDecodeWindowBuffer.hpp>
+#include <tudocomp/compressors/lzss/LZSSMatchFinder.hpp>
+#include <tudocomp/compressors/LZSSSlidingWindowCompressor.hpp>
+#include <tudocomp/compressors/LZSSLCPCompressor.hpp>
+#include <tudocomp/compressors/LZSSBlockCompressor.hpp>
+#include <tudocomp/coders/ASCIICoder.hpp>
+#include <tudocomp/coders/EliasGammaCoder.hpp>
+#include <tudocomp/coders/HuffmanCoder.hpp>
+
+#include "test/util.hpp"
 
 #include <tudocomp/compressors/lcpcomp/decompress/CompactDec.hpp>
 #include <tudocomp/compressors/lcpcomp/decompress/DecodeQueueListBuffer.hpp>
 #include <tudocomp/compressors/lcpcomp/decompress/MultiMapBuffer.hpp>
+#include <tudocomp/compressors/lcpcomp/decompress/SemiExternalDec.hpp>
 
 using namespace tdc;
 
@@ -150,6 +161,46 @@ TEST(lzss, decode_back_buffer) {
     ASSERT_EQ("bananabanana", ss.str());
 }
 
+TEST(lzss, copy_factor_overlap) {
+    for(size_t dist = 1; dist < 10; ++dist) {
+        for(size_t num = 0; num < 40; ++num) {
+            std::vector<uliteral_t> expected(10 + num);
+            for(size_t i = 0; i < 10; ++i) expected[i] = 'a' + i;
+            std::vector<uliteral_t> buf = expected;
+
+            for(size_t i = 0; i < num; ++i) expected[10 + i] = expected[10 - dist + i];
+            lzss::copy_factor(buf.data(), 10 - dist, 10, num);
+            ASSERT_EQ(expected, buf) << "dist = " << dist << ", num = " << num;
+        }
+    }
+}
+
+TEST(lzss, decode_window_buffer) {
+    // small window, such that the buffer has to slide
+    std::string text;
+    for(size_t i = 0; text.size() < 3000000; ++i) {
+        text += std::to_string(i % 1000);
+    }
+
+    std::stringstream ss;
+    lzss::DecodeWindowBuffer buffer(3, ss);
+    for(size_t i = 0; i < text.size();) {
+        if(i >= 3 && text[i] == text[i - 3]) {
+            size_t num = 1;
+            while(i + num < text.size() && num < 3 && text[i + num] == text[i + num - 3]) ++num;
+            buffer.decode_factor(3, num);
+            i += num;
+        } else {
+            buffer.decode_literal(text[i++]);
+        }
+        ASSERT_EQ(i, buffer.size());
+    }
+    ASSERT_THROW(buffer.decode_factor(4, 1), std::runtime_error);
+    buffer.flush();
+
+    ASSERT_EQ(text, ss.str());
+}
+
 template<typename T>
 void test_forward_decode_buffer_chain() {
     T buffer = create_algo<T>("", 12);
@@ -205,3 +256,193 @@ TEST(lzss, decode_forward_ql_buffer_chain) {
 TEST(lzss, decode_forward_ql_buffer_multiref) {
     test_forward_decode_buffer_multiref<lcpcomp::DecodeForwardQueueListBuffer>();
 }
+
+TEST(lzss, decode_forward_ext_buffer_chain) {
+    test_forward_decode_buffer_chain<lcpcomp::SemiExternalDec>();
+}
+
+TEST(lzss, decode_forward_ext_buffer_multiref) {
+    test_forward_decode_buffer_multiref<lcpcomp::SemiExternalDec>();
+}
+
+TEST(lzss, decode_forward_ext_buffer_spill) {
+    // with no budget, every pending factor is spilled to disk
+    const len_t period = 1 << 16;
+    const len_t n = 64 * period;
+    std::string text(n, 0);
+    for(len_t i = 0; i < n; ++i) text[i] = 'a' + (i % period) * 7919 % 26;
+
+    auto buffer = create_algo<lcpcomp::SemiExternalDec>("budget = 0", n);
+
+    // the first half refers to the second half, which refers to the last
+    // period, so the factors are resolved in more than one pass
+    const len_t factor = 64;
+    for(len_t i = 0; i < n - period; i += factor) {
+        const len_t source = (i < n / 2) ? i + n / 2 : n - period + i % period;
+        buffer.decode_factor(source, factor);
+    }
+    for(len_t i = n - period; i < n; ++i) buffer.decode_literal(text[i]);
+    buffer.decode_eagerly();
+    IF_STATS(ASSERT_GT(buffer.longest_chain(), 1U));
+
+    std::stringstream ss;
+    buffer.write_to(ss);
+    ASSERT_EQ(text, ss.str());
+}
+
+template<class finder_t>
+void test_match_finder(const std::string& text, size_t window, size_t depth) {
+    lzss::NaiveFinder naive(window, 0, 1);
+    finder_t finder(window, depth, 1);
+
+    const uliteral_t* buf = (const uliteral_t*) text.data();
+    for(size_t i = 0; i < text.size(); ++i) {
+        const size_t max_len = std::min(window, text.size() - i);
+        const lzss::Match expected = naive.find(buf, i, max_len);
+        const lzss::Match m = finder.find(buf, i, max_len);
+
+        // with unlimited depth, the longest match is found
+        ASSERT_EQ(expected.len, m.len) << "position " << i;
+        if(m.len > 0) {
+            ASSERT_LE(m.dist, std::min(i, window));
+            ASSERT_EQ(text.substr(i - m.dist, m.len), text.substr(i, m.len));
+        }
+    }
+}
+
+TEST(lzss, match_finder_hashchain) {
+    test::on_string_generators([](const std::string& text) {
+        test_match_finder<lzss::HashChainFinder>(text, 7, SIZE_MAX);
+        test_match_finder<lzss::HashChainFinder>(text, 64, SIZE_MAX);
+    }, 14);
+}
+
+TEST(lzss, match_finder_bt) {
+    test::on_string_generators([](const std::string& text) {
+        test_match_finder<lzss::BinaryTreeFinder>(text, 7, SIZE_MAX);
+        test_match_finder<lzss::BinaryTreeFinder>(text, 64, SIZE_MAX);
+    }, 14);
+}
+
+TEST(lzss, sliding_window_finders) {
+    for(std::string finder : {"naive", "hashchain", "bt"}) {
+        for(std::string window : {"0", "1", "16", "300"}) {
+            const std::string options = "finder = \"" + finder + "\", window = " + window;
+            auto f = [&](const std::string& text) {
+                test::roundtrip_ex<LZSSSlidingWindowCompressor<ASCIICoder>>(text, "", options);
+            };
+            test::roundtrip_batch(f);
+            test::on_string_generators(f, 12);
+        }
+    }
+}
+
+TEST(lzss, sliding_window_large) {
+    // larger than the buffer, which has to slide
+    std::string text;
+    for(size_t i = 0; text.size() < 300000; ++i) {
+        text += std::to_string(i * i % 7919);
+    }
+
+    for(std::string finder : {"naive", "hashchain", "bt"}) {
+        test::roundtrip_ex<LZSSSlidingWindowCompressor<ASCIICoder>>(text, "",
+            "finder = \"" + finder + "\", window = 100");
+    }
+    for(std::string finder : {"hashchain", "bt"}) {
+        test::roundtrip_ex<LZSSSlidingWindowCompressor<ASCIICoder>>(text, "",
+            "finder = \"" + finder + "\", window = 70000");
+    }
+}
+
+TEST(lzss, block) {
+    for(std::string block : {"1", "2", "16", "300"}) {
+        for(std::string threshold : {"1", "3"}) {
+            const std::string options = "block = " + block + ", threshold = " + threshold;
+            auto f = [&](const std::string& text) {
+                test::roundtrip_ex<LZSSBlockCompressor<ASCIICoder>>(text, "", options);
+            };
+            test::roundtrip_batch(f);
+            test::on_string_generators(f, 12);
+        }
+    }
+}
+
+TEST(lzss, block_large) {
+    std::string text;
+    for(size_t i = 0; text.size() < 300000; ++i) {
+        text += std::to_string(i * i % 7919);
+    }
+    test::roundtrip_ex<LZSSBlockCompressor<ASCIICoder>>(text, "", "block = 70000");
+    test::roundtrip_ex<LZSSBlockCompressor<EliasGammaCoder>>(text, "", "block = 4096");
+
+    // a repetition of a previous block is a single factor
+    std::string random;
+    for(size_t i = 0; random.size() < 10000; ++i) {
+        random += std::to_string(i * i * i % 1000003);
+    }
+    const std::string repeated = random + random;
+    auto compressed_size = [&](const std::string& text) {
+        return test::RoundTrip<LZSSBlockCompressor<ASCIICoder>>("block = 20000")
+            .compress(text).bytes.size();
+    };
+    ASSERT_LT(compressed_size(repeated), compressed_size(random) + 64);
+}
+
+#ifndef STATS_DISABLED
+TEST(lzss, block_file) {
+    // a file input is read block by block, so the memory used for
+    // compressing it does not depend on its size
+    std::string text;
+    for(size_t i = 0; text.size() < 4000000; ++i) {
+        text += std::to_string(i * i % 1000003);
+    }
+    test::write_test_file("lzss_block_file.txt", text);
+    const std::string path = test::test_file_path("lzss_block_file.txt");
+
+    auto compressor = create_algo<LZSSBlockCompressor<ASCIICoder>>("block = 4096");
+    std::vector<uint8_t> from_memory;
+    {
+        Input in(text);
+        Output out(from_memory);
+        compressor.compress(in, out);
+    }
+
+    std::string json;
+    {
+        StatPhase root("compress");
+        Input in = Input::from_path(path);
+        Output out = Output::from_path(io::Path(test::test_file_path("lzss_block_file.tdc")), true);
+        compressor.compress(in, out);
+        json = root.to_json().str();
+    }
+    const size_t peak = std::stoull(json.substr(json.find("\"memPeak\":") + 10));
+    ASSERT_LT(peak, text.size() / 2);
+
+    ASSERT_EQ(View(from_memory), View(test::read_test_file("lzss_block_file.tdc")));
+}
+#endif
+
+TEST(lzss, lcp_optimal_parse) {
+    for(std::string threshold : {"1", "3", "5"}) {
+        const std::string options = "parse = \"optimal\", threshold = " + threshold;
+        auto f = [&](const std::string& text) {
+            test::roundtrip_ex<LZSSLCPCompressor<ASCIICoder>>(text, "", options);
+            test::roundtrip_ex<LZSSLCPCompressor<EliasGammaCoder>>(text, "", options);
+            test::roundtrip_ex<LZSSLCPCompressor<HuffmanCoder>>(text, "", options);
+        };
+        test::roundtrip_batch(f);
+        test::on_string_generators(f, 10);
+    }
+}
+
+TEST(lzss, lcp_optimal_parse_smaller) {
+    std::string text;
+    for(size_t i = 0; text.size() < 100000; ++i) {
+        text += std::to_string(i * i % 7919);
+    }
+
+    auto compressed_size = [&](const std::string& options) {
+        return test::RoundTrip<LZSSLCPCompressor<EliasGammaCoder>>(options).compress(text).bytes.size();
+    };
+    ASSERT_LE(compressed_size("parse = \"optimal\""), compressed_size("parse = \"greedy\""));
+}
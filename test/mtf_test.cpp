@@ -26,3 +26,44 @@ TEST(MTF, string_test) {
 	std::function<void(std::string&)> func(test_mtf);
 	test::on_string_generators(func,20);
 }
+
+TEST(MTF, buffer) {
+	auto f = [](const std::string& input) {
+		std::stringstream mtfin{input};
+		std::stringstream mtfout;
+		mtf_encode(mtfin, mtfout);
+
+		// the same encoding as the stream-based one
+		std::vector<uliteral_t> buf(input.begin(), input.end());
+		mtf_encode(buf.data(), buf.size(), buf.data());
+		ASSERT_EQ(mtfout.str(), std::string(buf.begin(), buf.end()));
+
+		mtf_decode(buf.data(), buf.size(), buf.data());
+		ASSERT_EQ(input, std::string(buf.begin(), buf.end()));
+	};
+	test::roundtrip_batch(f);
+	test::on_string_generators(f, 20);
+}
+
+TEST(MTF, table) {
+	// all positions of the table, with the reference implementation
+	std::vector<uliteral_t> input;
+	for(size_t i = 0; i < 20000; ++i) input.push_back((i * i * 7919 + i / 3) % 256);
+
+	uliteral_t reference[ULITERAL_MAX+1];
+	std::iota(reference, reference+ULITERAL_MAX+1, 0);
+	MTFTable table;
+	for(uliteral_t c : input) {
+		ASSERT_EQ(mtf_encode_char(c, reference, ULITERAL_MAX+1), table.encode(c));
+	}
+
+	std::vector<uliteral_t> buf(input);
+	mtf_encode(buf.data(), buf.size(), buf.data());
+	mtf_decode(buf.data(), buf.size(), buf.data());
+	ASSERT_EQ(input, buf);
+}
+
+TEST(MTF, roundtrip) {
+	test::roundtrip_batch(test::roundtrip<MTFCompressor>);
+	test::on_string_generators(test::roundtrip<MTFCompressor>, 15);
+}
@@ -0,0 +1,250 @@
+#include <gtest/gtest.h>
+
+#include <tudocomp/compressors/RePairCompressor.hpp>
+#include <tudocomp/compressors/repair/Expander.hpp>
+#include <tudocomp/compressors/repair/LeanRePair.hpp>
+#include <tudocomp/compressors/repair/LinearRePair.hpp>
+#include <tudocomp/compressors/repair/NaiveRePair.hpp>
+#include <tudocomp/compressors/repair/ParallelRePair.hpp>
+#include <tudocomp/coders/ASCIICoder.hpp>
+#include <tudocomp/coders/HuffmanCoder.hpp>
+
+#include "test/util.hpp"
+
+using namespace tdc;
+using namespace tdc::repair;
+
+/// Expands the start rule of the grammar.
+std::string expand(const std::vector<sym_t>& start, const grammar_t& grammar) {
+    std::string s;
+    std::function<void(sym_t)> f = [&](sym_t x) {
+        if(x < sigma) {
+            s.push_back(char(x));
+        } else {
+            f(left(grammar[x - sigma]));
+            f(right(grammar[x - sigma]));
+        }
+    };
+    for(sym_t x : start) f(x);
+    return s;
+}
+
+template<typename F>
+void test_repair(F repair, const std::string& text, size_t max_rules) {
+    std::vector<sym_t> start(text.begin(), text.end());
+    for(auto& x : start) x = uliteral_t(x);
+
+    grammar_t grammar;
+    repair(start, grammar, max_rules);
+    ASSERT_LE(grammar.size(), max_rules);
+    ASSERT_EQ(text, expand(start, grammar));
+
+    // no digram of the start rule occurs twice without overlap
+    if(grammar.size() < max_rules) {
+        std::unordered_map<digram_t, size_t> last;
+        for(size_t i = 0; i + 1 < start.size(); ++i) {
+            const digram_t di = digram(start[i], start[i + 1]);
+            auto it = last.find(di);
+            if(it != last.end()) ASSERT_EQ(it->second + 1, i);
+            last[di] = i;
+        }
+    }
+}
+
+TEST(repair, linear) {
+    auto f = [](const std::string& text) {
+        test_repair(linear_repair, text, SIZE_MAX);
+        test_repair(linear_repair, text, 3);
+    };
+    test::roundtrip_batch(f);
+    test::on_string_generators(f, 15);
+}
+
+TEST(repair, naive) {
+    auto f = [](const std::string& text) {
+        test_repair(naive_repair, text, SIZE_MAX);
+    };
+    test::roundtrip_batch(f);
+    test::on_string_generators(f, 12);
+}
+
+TEST(repair, lean) {
+    // the same grammar as the naive algorithm
+    auto f = [](const std::string& text) {
+        std::vector<sym_t> naive(text.begin(), text.end());
+        for(auto& x : naive) x = uliteral_t(x);
+        grammar_t naive_grammar;
+        naive_repair(naive, naive_grammar, SIZE_MAX);
+
+        DynamicIntVector lean(text.size(), 0, 8);
+        for(size_t i = 0; i < text.size(); ++i) lean[i] = uliteral_t(text[i]);
+        grammar_t lean_grammar;
+        lean_repair(lean, lean_grammar, SIZE_MAX);
+
+        ASSERT_EQ(naive_grammar, lean_grammar);
+        ASSERT_EQ(naive.size(), lean.size());
+        for(size_t i = 0; i < naive.size(); ++i) ASSERT_EQ(naive[i], sym_t(lean[i]));
+        if(lean_grammar.size() > 0) ASSERT_EQ(size_t(lean.width()), size_t(bits_for(sigma + lean_grammar.size() - 1)));
+    };
+    test::roundtrip_batch(f);
+    test::on_string_generators(f, 12);
+}
+
+TEST(repair, parallel) {
+    // the same grammar as the naive algorithm, with chunks of any size
+    auto f = [](const std::string& text) {
+        std::vector<sym_t> naive(text.begin(), text.end());
+        for(auto& x : naive) x = uliteral_t(x);
+        grammar_t naive_grammar;
+        naive_repair(naive, naive_grammar, SIZE_MAX);
+
+        for(size_t threads : {2, 3, 8}) {
+            for(size_t min_chunk : {1, 5}) {
+                std::vector<sym_t> parallel(text.begin(), text.end());
+                for(auto& x : parallel) x = uliteral_t(x);
+                grammar_t parallel_grammar;
+                parallel_repair(parallel, parallel_grammar, SIZE_MAX, threads, min_chunk);
+
+                ASSERT_EQ(naive_grammar, parallel_grammar);
+                ASSERT_EQ(naive, parallel);
+            }
+        }
+    };
+    test::roundtrip_batch(f);
+    test::on_string_generators(f, 11);
+}
+
+TEST(repair, linear_runs) {
+    // overlapping occurrences of xx are counted once
+    std::vector<sym_t> text(7, 'a');
+    grammar_t grammar;
+    linear_repair(text, grammar, SIZE_MAX);
+    ASSERT_EQ(grammar, (grammar_t { digram('a', 'a') }));
+    ASSERT_EQ(text, (std::vector<sym_t> { sigma, sigma, sigma, 'a' }));
+
+    text.assign(8, 'a');
+    grammar.clear();
+    linear_repair(text, grammar, SIZE_MAX);
+    ASSERT_EQ(grammar, (grammar_t { digram('a', 'a'), digram(sigma, sigma) }));
+    ASSERT_EQ(text, (std::vector<sym_t> { sigma + 1, sigma + 1 }));
+}
+
+TEST(repair, expander) {
+    std::string text;
+    for(size_t i = 0; text.size() < 200000; ++i) {
+        text += std::to_string(i * i % 7919);
+    }
+    std::vector<sym_t> start(text.begin(), text.end());
+    grammar_t grammar;
+    linear_repair(start, grammar, SIZE_MAX);
+
+    // with and without cached rules
+    for(size_t cache_size : {0, 100, 1 << 20}) {
+        Expander expander(grammar, cache_size, 16);
+        std::ostringstream out;
+        size_t length = 0;
+        for(sym_t x : start) {
+            expander.expand(x, out);
+            length += expander.length(x);
+        }
+        expander.flush(out);
+        ASSERT_EQ(text.size(), length);
+        ASSERT_EQ(text, out.str());
+    }
+
+    // a deep grammar
+    grammar_t chain { digram('a', 'b') };
+    for(size_t k = 1; k < 100000; ++k) chain.push_back(digram(sigma + k - 1, 'c'));
+    Expander expander(chain, 0);
+    std::ostringstream out;
+    expander.expand(sigma + chain.size() - 1, out);
+    expander.flush(out);
+    ASSERT_EQ(out.str(), "ab" + std::string(chain.size() - 1, 'c'));
+
+    // a rule referring to itself
+    ASSERT_THROW(Expander(grammar_t { digram('a', sigma) }), std::runtime_error);
+}
+
+TEST(repair, extract) {
+    std::string text;
+    for(size_t i = 0; text.size() < 20000; ++i) {
+        text += std::to_string(i * i % 7919);
+    }
+
+    for(std::string sample : {"0", "1", "7"}) {
+        const std::string options = "sample = " + sample;
+        test::roundtrip_ex<RePairCompressor<ASCIICoder>>(text, "", options);
+        auto compressed = test::RoundTrip<RePairCompressor<ASCIICoder>>(options).compress(text);
+
+        auto extract = [&](size_t from, size_t to) {
+            auto compressor = create_algo<RePairCompressor<ASCIICoder>>(options);
+            Input input = Input::from_memory(compressed.bytes);
+            std::vector<uint8_t> buffer;
+            {
+                Output output = Output::from_memory(buffer);
+                compressor.extract(input, output, from, to);
+            }
+            return std::string(buffer.begin(), buffer.end());
+        };
+
+        for(size_t from : {0, 1, 17, 1000, 12345, 19999}) {
+            for(size_t len : {0, 1, 2, 5, 100, 3000}) {
+                ASSERT_EQ(text.substr(from, len), extract(from, from + len));
+            }
+        }
+        ASSERT_EQ(text, extract(0, SIZE_MAX));
+        ASSERT_EQ("", extract(text.size() + 10, text.size() + 20));
+    }
+}
+
+TEST(repair, extract_sampled) {
+    std::string text;
+    for(size_t i = 0; text.size() < 20000; ++i) {
+        text += std::to_string(i * i % 7919);
+    }
+    auto compressed = test::RoundTrip<RePairCompressor<ASCIICoder>>("sample = 7").compress(text);
+    std::vector<uint8_t> bytes = compressed.bytes;
+
+    // find the start rule behind the grammar frame and the samples
+    const uint8_t* in = bytes.data();
+    const uint8_t* end = in + bytes.size();
+    in += read_vbyte<size_t>(in, end);
+    const size_t n = read_vbyte<size_t>(in, end);
+    const size_t length = read_vbyte<size_t>(in, end);
+    ASSERT_EQ(text.size(), length);
+    const size_t begin = (in - bytes.data()) + ((n - 1) / 7 * bits_for(length) + 7) / 8;
+
+    // the symbols before the sample of the part are not read
+    std::fill(bytes.begin() + begin, bytes.begin() + (begin + bytes.size()) / 2, 0xFF);
+    auto compressor = create_algo<RePairCompressor<ASCIICoder>>("sample = 7");
+    Input input = Input::from_memory(bytes);
+    std::vector<uint8_t> buffer;
+    {
+        Output output = Output::from_memory(buffer);
+        compressor.extract(input, output, text.size() - 100, text.size());
+    }
+    ASSERT_EQ(text.substr(text.size() - 100), std::string(buffer.begin(), buffer.end()));
+}
+
+TEST(repair, roundtrip_threads) {
+    std::string text;
+    for(size_t i = 0; text.size() < 30000; ++i) {
+        text += std::to_string(i * i % 7919);
+    }
+    test::roundtrip_ex<RePairCompressor<ASCIICoder>>(text, "",
+        "mode = \"naive\", threads = 4, max_rules = 50");
+}
+
+TEST(repair, roundtrip) {
+    for(std::string mode : {"linear", "naive", "lean"}) {
+        for(std::string max_rules : {"0", "5"}) {
+            const std::string options = "mode = \"" + mode + "\", max_rules = " + max_rules;
+            auto f = [&](const std::string& text) {
+                test::roundtrip_ex<RePairCompressor<ASCIICoder>>(text, "", options);
+                test::roundtrip_ex<RePairCompressor<HuffmanCoder>>(text, "", options);
+            };
+            test::roundtrip_batch(f);
+            test::on_string_generators(f, 12);
+        }
+    }
+}
@@ -19,3 +19,53 @@ TEST(RLE, string_test) {
 	std::function<void(std::string&)> func(test_rle);
 	test::on_string_generators(func,20);
 }
+
+TEST(RLE, buffer) {
+	auto f = [](const std::string& input) {
+		std::stringstream rleout;
+		std::stringstream rlein{input};
+		rle_encode(rlein, rleout);
+
+		// the same encoding as the stream-based one
+		const uliteral_t* in = reinterpret_cast<const uliteral_t*>(input.data());
+		std::vector<uliteral_t> encoded(input.size() + input.size() / 2 + 1);
+		encoded.resize(rle_encode(in, input.size(), encoded.data()));
+		ASSERT_EQ(rleout.str(), std::string(encoded.begin(), encoded.end()));
+
+		std::vector<uliteral_t> decoded(input.size());
+		ASSERT_EQ(input.size(), rle_decode(encoded.data(), encoded.size(), decoded.data(), decoded.size()));
+		ASSERT_EQ(input, std::string(decoded.begin(), decoded.end()));
+		if(input.size() > 0) {
+			ASSERT_THROW(rle_decode(encoded.data(), encoded.size(), decoded.data(), input.size() - 1), std::runtime_error);
+		}
+	};
+	test::roundtrip_batch(f);
+	test::on_string_generators(f, 20);
+}
+
+TEST(RLE, compressor) {
+	// runs crossing the chunks of the encoder
+	std::string long_runs;
+	for(size_t i = 0; long_runs.size() < 300000; ++i) {
+		long_runs += std::string((i * 7919) % 70000 + 1, char('a' + i % 3));
+		long_runs += "xyz";
+	}
+
+	for(std::string offset : {"0", "3"}) {
+		auto f = [&](const std::string& input) {
+			std::stringstream rleout;
+			std::stringstream rlein{input};
+			rle_encode(rlein, rleout, std::stoul(offset));
+
+			auto compressed = test::RoundTrip<RunLengthEncoder>("offset = " + offset).compress(input);
+			const std::string encoded = rleout.str();
+			ASSERT_EQ(std::vector<uint8_t>(encoded.begin(), encoded.end()), compressed.bytes);
+			compressed.assert_decompress();
+		};
+		test::roundtrip_batch(f);
+		test::on_string_generators(f, 15);
+		f(long_runs);
+		f(std::string(200000, 'a'));
+		f(std::string(65536, 'a') + "b");
+	}
+}
@@ -1,5 +1,6 @@
 #include <algorithm>
 #include <iostream>
+#include <random>
 #include <sstream>
 #include <stdexcept>
 #include <utility>
@@ -726,6 +727,52 @@ TEST(IO, bits_eof) {
     }
 }
 
+TEST(IO, bits_words) {
+    // write integers of all widths across several buffers and compare the
+    // output to the bits written one by one
+    std::mt19937_64 rng(42);
+    std::vector<std::pair<uint64_t, size_t>> values;
+    for(size_t i = 0; i < 10000; i++) {
+        const size_t w = rng() % 65;
+        const uint64_t v = rng() & (w < 64 ? (uint64_t(1) << w) - 1 : uint64_t(-1));
+        values.emplace_back(v, w);
+    }
+
+    for(size_t extra = 0; extra < 8; extra++) {
+        std::ostringstream ss_words, ss_bits;
+        size_t num_bits = 0;
+        {
+            Output output(ss_words);
+            BitOStream out(output);
+            for(auto& x : values) out.write_int(x.first, x.second);
+            out.write_unary(100U);
+            out.write_int(uint16_t(0xA5A5), extra);
+            num_bits = out.bits_written();
+        }
+        {
+            Output output(ss_bits);
+            BitOStream out(output);
+            for(auto& x : values) {
+                for(size_t k = x.second; k > 0; k--) out.write_bit((x.first >> (k - 1)) & 1);
+            }
+            for(size_t k = 0; k < 100; k++) out.write_bit(0);
+            out.write_bit(1);
+            for(size_t k = extra; k > 0; k--) out.write_bit((0xA5A5 >> (k - 1)) & 1);
+            ASSERT_EQ(num_bits, out.bits_written());
+        }
+        const std::string result = ss_words.str();
+        ASSERT_EQ(ss_bits.str(), result);
+        ASSERT_EQ(num_bits / 8 + ((num_bits % 8) >= 6 ? 2 : 1), result.size());
+
+        Input input(result);
+        BitIStream in(input);
+        for(auto& x : values) ASSERT_EQ(x.first, in.read_int<uint64_t>(x.second));
+        ASSERT_EQ(100U, in.read_unary<size_t>());
+        ASSERT_EQ(0xA5A5U & ((1U << extra) - 1), in.read_int<uint16_t>(extra));
+        ASSERT_TRUE(in.eof());
+    }
+}
+
 TEST(View, construction) {
     static const uint8_t DATA[3] = { 'f', 'o', 'o' };
 